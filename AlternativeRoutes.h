@@ -0,0 +1,229 @@
+/**
+ * @file AlternativeRoutes.h
+ * @brief Several good routes between two vertices instead of only the fastest one.
+ *
+ * Two ways of finding alternatives are offered. Yen's algorithm finds the k shortest loopless paths exactly,
+ * at the cost of one "spur" search per vertex of every path found; the penalty method runs a few searches
+ * that each make the edges of the routes found so far more expensive, which is faster and naturally gives
+ * routes that differ more. In both cases the routes shown are chosen fastest first among the candidates,
+ * skipping any that share too much of their time with a route already chosen.
+ */
+
+#ifndef ALTERNATIVE_ROUTES_H
+#define ALTERNATIVE_ROUTES_H
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "dijkstra.h"
+#include "./data_structures/TopK.h"
+
+/**
+ * @brief How alternatives are found and which are shown.
+ */
+struct AlternativeOptions {
+    enum Method { YEN, PENALTY };
+
+    Method method = YEN;
+    size_t count = 3;           ///< Routes wanted, the fastest included.
+    size_t candidates = 10;     ///< Yen: shortest paths generated; penalty method: searches run. At least count.
+    double maxSimilarity = 1.0; ///< Largest share of a route's time it may spend on a faster chosen route; 1 keeps all.
+    double penalty = 0.5;       ///< Penalty method: share of an edge's time added each time a route uses it.
+};
+
+/**
+ * @brief A route found while looking for alternatives: its edges from the source and its time.
+ */
+template <class T>
+struct CandidateRoute {
+    std::vector<Edge<T> *> edges;
+    Distance cost;
+};
+
+/*
+ * Collects the edges of the path a search found from its start to a vertex, appending them to edges.
+ */
+template <class T>
+void appendSearchPath(const SearchWorkspace<T> &search, const Vertex<T> *target, std::vector<Edge<T> *> &edges) {
+    size_t first = edges.size();
+    for (Edge<T> *e = search.getPath(target); e != nullptr; e = search.getPath(e->getOrig())) edges.push_back(e);
+    std::reverse(edges.begin() + first, edges.end());
+}
+
+/**
+ * @brief Returns the share of a route's time spent on edges another route also uses, from 0 to 1.
+ *
+ * @complexity O(A + B), for routes of A and B edges.
+ */
+template <class T, class WeightPolicy>
+double routeSimilarity(const CandidateRoute<T> &route, const CandidateRoute<T> &other, const WeightPolicy &weight) {
+    if (route.cost == 0) return route.edges.empty() && !other.edges.empty() ? 0.0 : 1.0;
+    std::unordered_set<const Edge<T> *> shared(other.edges.begin(), other.edges.end());
+    Distance time = 0;
+    for (const Edge<T> *e : route.edges) {
+        if (shared.count(e)) time = saturatingAdd(time, weight(e));
+    }
+    return (double) time / route.cost;
+}
+
+/**
+ * @brief Finds the k shortest loopless paths from a source to a target with Yen's algorithm.
+ *
+ * A reverse search from the target gives the exact remaining time from every vertex, which is a lower bound
+ * for every spur search (avoiding more only makes paths longer). A spur search is skipped when even that
+ * bound cannot beat the candidates already kept, and every spur search stops as soon as it reaches the
+ * target. Only the k - (paths found) best candidates are kept, since worse ones can never be chosen.
+ *
+ * @tparam WeightPolicy The weight policy, such as DrivingTime or WalkingTime.
+ * @param search, reverse Workspaces for the spur searches and for the reverse search.
+ * @return Up to k paths, fastest first; fewer if no more loopless paths exist.
+ *
+ * @complexity O(k L (R + A) \log R), for paths of up to L edges and spur searches reaching R vertices and
+ * A edges.
+ */
+template <class T, class WeightPolicy>
+std::vector<CandidateRoute<T>> yenShortestPaths(const Graph<T> *g, const Vertex<T> *source, const Vertex<T> *target,
+                                                size_t k, const WeightPolicy &weight,
+                                                const std::vector<Vertex<T> *> &nodesToAvoid,
+                                                const std::vector<Edge<T> *> &segmentsToAvoid,
+                                                SearchWorkspace<T> &search, SearchWorkspace<T> &reverse) {
+    typedef CandidateRoute<T> Route;
+    std::vector<Route> found;
+    if (k == 0) return found;
+
+    reverseDijkstra(g, target, nodesToAvoid, segmentsToAvoid, weight, reverse);
+    if (reverse.getDist(source) == UNREACHABLE || source == target) return found;
+    Route first{{}, reverse.getDist(source)};
+    for (const Vertex<T> *v = source; v != target; v = reverse.getPath(v)->getDest()) {
+        first.edges.push_back(reverse.getPath(v));
+    }
+    found.push_back(first);
+
+    std::vector<Route> candidates; // best first; equal costs in the order they were found
+    std::set<std::vector<Edge<T> *>> seen = {first.edges};
+    auto stopAtTarget = [target](const Vertex<T> *v, Distance) { return v != target; };
+
+    while (found.size() < k) {
+        const Route last = found.back();
+        const size_t slots = k - found.size();
+        std::vector<Vertex<T> *> avoidNodes = nodesToAvoid;
+        Distance rootCost = 0;
+
+        for (size_t i = 0; i < last.edges.size(); i++) {
+            Vertex<T> *spur = last.edges[i]->getOrig();
+            Distance bound = saturatingAdd(rootCost, reverse.getDist(spur));
+            if (candidates.size() < slots || bound < candidates.back().cost) {
+                // Leave the spur vertex by an edge no found path with the same root uses
+                std::vector<Edge<T> *> avoidEdges = segmentsToAvoid;
+                for (const Route &r : found) {
+                    if (r.edges.size() > i && std::equal(last.edges.begin(), last.edges.begin() + i, r.edges.begin())) {
+                        avoidEdges.push_back(r.edges[i]);
+                    }
+                }
+                dijkstra(g, spur, avoidNodes, avoidEdges, weight, search, UNREACHABLE, stopAtTarget);
+
+                if (search.isVisited(target)) {
+                    Route r{std::vector<Edge<T> *>(last.edges.begin(), last.edges.begin() + i),
+                            saturatingAdd(rootCost, search.getDist(target))};
+                    appendSearchPath(search, target, r.edges);
+                    if (seen.insert(r.edges).second) {
+                        auto at = std::upper_bound(candidates.begin(), candidates.end(), r,
+                                                   [](const Route &a, const Route &b) { return a.cost < b.cost; });
+                        candidates.insert(at, r);
+                        if (candidates.size() > slots) candidates.pop_back();
+                    }
+                }
+            }
+            rootCost = saturatingAdd(rootCost, weight(last.edges[i]));
+            avoidNodes.push_back(spur); // The root must stay loopless
+        }
+
+        if (candidates.empty()) break;
+        found.push_back(candidates.front());
+        candidates.erase(candidates.begin());
+    }
+    return found;
+}
+
+/**
+ * @brief Finds distinct routes from a source to a target with the penalty method.
+ *
+ * Each round runs one search, stopped at the target, in which every edge used by an earlier route costs
+ * (1 + penalty) times more per use; routes are returned with their real times.
+ *
+ * @return The distinct routes found, in the order they were found.
+ *
+ * @complexity O(rounds (R + A) \log R), for searches reaching R vertices and A edges.
+ */
+template <class T, class WeightPolicy>
+std::vector<CandidateRoute<T>> penaltyRoutes(const Graph<T> *g, const Vertex<T> *source, const Vertex<T> *target,
+                                             size_t rounds, double penalty, const WeightPolicy &weight,
+                                             const std::vector<Vertex<T> *> &nodesToAvoid,
+                                             const std::vector<Edge<T> *> &segmentsToAvoid,
+                                             SearchWorkspace<T> &search) {
+    std::vector<CandidateRoute<T>> routes;
+    std::set<std::vector<Edge<T> *>> seen;
+    std::unordered_map<int, Distance> penalties;
+    PenalizedTime<WeightPolicy> penalized{weight, &penalties};
+    auto stopAtTarget = [target](const Vertex<T> *v, Distance) { return v != target; };
+
+    for (size_t round = 0; round < rounds; round++) {
+        dijkstra(g, source, nodesToAvoid, segmentsToAvoid, penalized, search, UNREACHABLE, stopAtTarget);
+        if (!search.isVisited(target)) break;
+
+        CandidateRoute<T> route{{}, 0};
+        appendSearchPath(search, target, route.edges);
+        for (Edge<T> *e : route.edges) {
+            Distance time = weight(e);
+            route.cost = saturatingAdd(route.cost, time);
+            Distance &extra = penalties[e->getIndex()];
+            extra = saturatingAdd(extra, std::max<Distance>(1, static_cast<Distance>(penalty * time)));
+        }
+        if (seen.insert(route.edges).second) routes.push_back(route);
+    }
+    return routes;
+}
+
+/**
+ * @brief Finds up to options.count good routes from a source to a target, fastest first.
+ *
+ * Candidates come from Yen's algorithm or the penalty method (see AlternativeOptions) and are chosen
+ * fastest first, skipping those more similar than options.maxSimilarity to a route already chosen.
+ *
+ * @tparam WeightPolicy The weight policy, such as DrivingTime or WalkingTime.
+ * @param search, reverse Workspaces for the searches; reverse is only used by Yen's algorithm.
+ * @return The routes as single-leg paths whose time is the route's time; empty if the target cannot be reached.
+ */
+template <class T, class WeightPolicy>
+std::vector<Path<T>> findAlternativeRoutes(const Graph<T> *g, const Vertex<T> *source, const Vertex<T> *target,
+                                           const WeightPolicy &weight, const AlternativeOptions &options,
+                                           SearchWorkspace<T> &search, SearchWorkspace<T> &reverse,
+                                           const std::vector<Vertex<T> *> &nodesToAvoid = {},
+                                           const std::vector<Edge<T> *> &segmentsToAvoid = {}) {
+    size_t generated = std::max(options.candidates, options.count);
+    std::vector<CandidateRoute<T>> candidates = options.method == AlternativeOptions::YEN
+        ? yenShortestPaths(g, source, target, generated, weight, nodesToAvoid, segmentsToAvoid, search, reverse)
+        : penaltyRoutes(g, source, target, generated, options.penalty, weight, nodesToAvoid, segmentsToAvoid, search);
+
+    auto faster = [](const CandidateRoute<T> &a, const CandidateRoute<T> &b) { return a.cost < b.cost; };
+    auto diverse = [&](const CandidateRoute<T> &route, const std::vector<CandidateRoute<T>> &chosen) {
+        for (const CandidateRoute<T> &other : chosen) {
+            if (routeSimilarity(route, other, weight) > options.maxSimilarity) return false;
+        }
+        return true;
+    };
+
+    std::vector<Path<T>> routes;
+    for (const CandidateRoute<T> &route : selectTopK(candidates, options.count, faster, diverse)) {
+        Path<T> path(source);
+        for (const Edge<T> *e : route.edges) path.push(e, 0);
+        path.setLegTime((int) route.cost);
+        routes.push_back(path);
+    }
+    return routes;
+}
+
+#endif //ALTERNATIVE_ROUTES_H
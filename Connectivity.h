@@ -0,0 +1,212 @@
+/**
+ * @file Connectivity.h
+ * @brief Connected components, cut vertices and bridges of one travel mode, to rule out routes without searching.
+ *
+ * When no route exists, Dijkstra's algorithm only finds out after exploring everything the source can reach.
+ * Components answer "no route" for vertices that are not connected at all, and a depth-first search in the
+ * style of Tarjan (entry numbers and low links) finds the vertices and edges that every route between two
+ * vertices must use: avoiding one of those leaves no route either.
+ */
+
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "./data_structures/Graph.h"
+
+/**
+ * @class Connectivity
+ * @brief Connectivity of the edges usable in one travel mode, ignoring their direction.
+ *
+ * Every answer is conservative: false from connected() and true from separates() prove that there is no
+ * route, but connected vertices may still have no route between them when one-way edges point the wrong way.
+ * The information reflects the graph when build() was called and must be rebuilt after it changes.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class Connectivity {
+public:
+    /**
+     * @brief Computes the components, cut vertices and bridges of a graph.
+     *
+     * @param g The graph.
+     * @param weight Weight policy (see dijkstra.h) whose adjacency() gives the edges usable in the mode.
+     *
+     * @complexity O(V + E)
+     */
+    template <class WeightPolicy>
+    void build(const Graph<T> &g, const WeightPolicy &weight);
+
+    bool isBuilt() const { return built; }
+
+    int getNumComponents() const { return numComponents; }
+
+    /**
+     * @brief Tells whether two vertices are in the same component; if not, there is no route between them.
+     */
+    bool connected(const Vertex<T> *s, const Vertex<T> *t) const {
+        return component[s->getIndex()] == component[t->getIndex()];
+    }
+
+    /**
+     * @brief Tells whether every route between two connected vertices passes through another vertex.
+     */
+    bool separates(const Vertex<T> *a, const Vertex<T> *s, const Vertex<T> *t) const {
+        if (a == s || a == t || !connected(a, s) || !connected(s, t)) return false;
+        return side(a->getIndex(), s->getIndex()) != side(a->getIndex(), t->getIndex());
+    }
+
+    /**
+     * @brief Tells whether every route from s to t uses an edge, in its direction.
+     */
+    bool separates(const Edge<T> *e, const Vertex<T> *s, const Vertex<T> *t) const {
+        if ((size_t) e->getIndex() >= linkOf.size() || linkOf[e->getIndex()] < 0 || !connected(s, t)) return false;
+        int c = treeChild[linkOf[e->getIndex()]];
+        if (c < 0 || low[c] <= entry[parent[c]]) return false; // Not a bridge
+        bool sInside = inSubtree(c, s->getIndex()), tInside = inSubtree(c, t->getIndex());
+        return sInside != tInside && inSubtree(c, e->getOrig()->getIndex()) == sInside;
+    }
+
+    /**
+     * @brief Tells whether avoiding some vertices and edges certainly leaves no route from s to t, because
+     * the vertices are not connected or one of the avoided vertices or edges is on every route.
+     *
+     * @complexity O(N log D + S), for N vertices and S edges to avoid and a largest degree D.
+     */
+    bool cutOff(const Vertex<T> *s, const Vertex<T> *t, const std::vector<Vertex<T> *> &nodesToAvoid,
+                const std::vector<Edge<T> *> &segmentsToAvoid) const {
+        if (!connected(s, t)) return true;
+        for (const Vertex<T> *a : nodesToAvoid) {
+            if (separates(a, s, t)) return true;
+        }
+        for (const Edge<T> *e : segmentsToAvoid) {
+            if (separates(e, s, t)) return true;
+        }
+        return false;
+    }
+
+private:
+    bool built = false;
+    int numComponents = 0;
+    std::vector<int> component;  // by vertex position
+    std::vector<int> entry;      // depth-first entry number, by vertex position
+    std::vector<int> exit;       // one past the largest entry number in the subtree
+    std::vector<int> low;        // smallest entry number reachable from the subtree through one non-tree link
+    std::vector<int> parent;     // in the depth-first tree, -1 for roots
+    std::vector<int> childStart; // children of each vertex, in entry order, in children
+    std::vector<int> children;
+    std::vector<int> linkOf;     // undirected link of each edge index, -1 if unusable
+    std::vector<int> treeChild;  // the child a link leads to in the depth-first tree, -1 for non-tree links
+
+    bool inSubtree(int root, int v) const { return entry[root] <= entry[v] && entry[v] < exit[root]; }
+
+    /*
+     * The part of the component of a that remains connected to v when a is removed: the child of a whose
+     * subtree contains v if no link leaves that subtree past a, or -1 for the part containing the rest.
+     */
+    int side(int a, int v) const {
+        if (!inSubtree(a, v)) return -1;
+        auto first = children.begin() + childStart[a], last = children.begin() + childStart[a + 1];
+        auto it = std::upper_bound(first, last, entry[v], [this](int e, int c) { return e < entry[c]; });
+        int c = *(it - 1);
+        return low[c] >= entry[a] ? c : -1;
+    }
+};
+
+template <class T>
+template <class WeightPolicy>
+void Connectivity<T>::build(const Graph<T> &g, const WeightPolicy &weight) {
+    const std::vector<Vertex<T> *> &vertices = g.getVertexSet();
+    const int n = vertices.size();
+
+    // Undirected links: one per two-way segment, one per one-way edge
+    std::vector<std::pair<int, int>> links;
+    linkOf.assign(g.getNumEdges(), -1);
+    for (const Vertex<T> *v : vertices) {
+        for (const Edge<T> *e : weight.adjacency(v)) {
+            const Edge<T> *reverse = e->getReverse();
+            if (e->isUndirected() && reverse != nullptr) {
+                if (e->getIndex() > reverse->getIndex()) continue;
+                linkOf[reverse->getIndex()] = links.size();
+            }
+            linkOf[e->getIndex()] = links.size();
+            links.emplace_back(v->getIndex(), e->getDest()->getIndex());
+        }
+    }
+    std::vector<int> adjStart(n + 1, 0), adj(2 * links.size()), adjLink(2 * links.size());
+    for (const std::pair<int, int> &l : links) {
+        adjStart[l.first + 1]++;
+        adjStart[l.second + 1]++;
+    }
+    for (int v = 0; v < n; v++) adjStart[v + 1] += adjStart[v];
+    std::vector<int> fill(adjStart.begin(), adjStart.end() - 1);
+    for (size_t k = 0; k < links.size(); k++) {
+        adj[fill[links[k].first]] = links[k].second;
+        adjLink[fill[links[k].first]++] = k;
+        adj[fill[links[k].second]] = links[k].first;
+        adjLink[fill[links[k].second]++] = k;
+    }
+
+    // Iterative depth-first search, skipping only the tree link a vertex was entered by
+    component.assign(n, -1);
+    entry.assign(n, -1);
+    exit.assign(n, 0);
+    low.assign(n, 0);
+    parent.assign(n, -1);
+    treeChild.assign(links.size(), -1);
+    std::vector<int> parentLink(n, -1), next(n, 0), byEntry;
+    byEntry.reserve(n);
+    std::vector<int> stack;
+    numComponents = 0;
+    for (int root = 0; root < n; root++) {
+        if (entry[root] >= 0) continue;
+        entry[root] = low[root] = byEntry.size();
+        byEntry.push_back(root);
+        component[root] = numComponents;
+        next[root] = adjStart[root];
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int v = stack.back();
+            if (next[v] < adjStart[v + 1]) {
+                int i = next[v]++;
+                int u = adj[i];
+                if (adjLink[i] == parentLink[v]) continue;
+                if (entry[u] >= 0) {
+                    low[v] = std::min(low[v], entry[u]);
+                    continue;
+                }
+                entry[u] = low[u] = byEntry.size();
+                byEntry.push_back(u);
+                component[u] = numComponents;
+                parent[u] = v;
+                parentLink[u] = adjLink[i];
+                treeChild[adjLink[i]] = u;
+                next[u] = adjStart[u];
+                stack.push_back(u);
+            } else {
+                stack.pop_back();
+                exit[v] = byEntry.size();
+                if (parent[v] >= 0) low[parent[v]] = std::min(low[parent[v]], low[v]);
+            }
+        }
+        numComponents++;
+    }
+
+    childStart.assign(n + 1, 0);
+    for (int v = 0; v < n; v++) {
+        if (parent[v] >= 0) childStart[parent[v] + 1]++;
+    }
+    for (int v = 0; v < n; v++) childStart[v + 1] += childStart[v];
+    children.assign(childStart[n], 0);
+    fill.assign(childStart.begin(), childStart.end() - 1);
+    for (int v : byEntry) {
+        if (parent[v] >= 0) children[fill[parent[v]]++] = v;
+    }
+    built = true;
+}
+
+#endif //CONNECTIVITY_H
@@ -0,0 +1,281 @@
+/**
+ * @file CoreGraph.h
+ * @brief A smaller graph to search, with degree-2 chains contracted and dead-end trees removed.
+ *
+ * Most locations of the network are pass-through stops with exactly two neighbours, or lie on dead-end
+ * spurs. A shortest path between two other vertices never enters a dead end, and crosses a chain of
+ * pass-through stops from one end to the other, so the search can run on the core of the graph: the vertices
+ * that are neither, joined by one shortcut edge per chain. Paths found in the core are unpacked back into the
+ * original vertices and edges before they are shown.
+ */
+
+#ifndef CORE_GRAPH_H
+#define CORE_GRAPH_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "./data_structures/Graph.h"
+#include "./data_structures/GraphBuilder.h"
+#include "./data_structures/Path.h"
+
+/**
+ * @class CoreGraph
+ * @brief The core of a graph, with the mapping between its vertices and edges and the original ones.
+ *
+ * A vertex is kept in the core if it has parking, is listed as kept (query endpoints, vertices to avoid, ends
+ * of segments to avoid), has a one-way edge, or has other than two neighbours once dead ends are removed.
+ * Searches between core vertices give the same distances on the core as on the original graph.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class CoreGraph {
+public:
+    /**
+     * @brief Builds the core of a graph.
+     *
+     * @param g The original graph. It must outlive the core and must not change while the core is used.
+     * @param keep Vertices that must stay in the core.
+     *
+     * @complexity O(V + E)
+     */
+    CoreGraph(const Graph<T> &g, const std::vector<const Vertex<T> *> &keep);
+
+    /**
+     * @brief Returns the core, to run searches on.
+     */
+    Graph<T> &getGraph() { return core; }
+
+    /**
+     * @brief Returns the core vertex of an original vertex, or nullptr if it was contracted or pruned.
+     */
+    Vertex<T> *toCore(const Vertex<T> *v) const { return coreOf[v->getIndex()]; }
+
+    /**
+     * @brief Returns the core edge of an original edge between two core vertices, or nullptr.
+     */
+    Edge<T> *toCore(const Edge<T> *e) const {
+        auto it = coreEdgeOf.find(e);
+        return it == coreEdgeOf.end() ? nullptr : it->second;
+    }
+
+    /**
+     * @brief Translates a list of vertices or edges to avoid, leaving out those that are not in the core.
+     */
+    std::vector<Vertex<T> *> toCore(const std::vector<Vertex<T> *> &vertices) const;
+    std::vector<Edge<T> *> toCore(const std::vector<Edge<T> *> &edges) const;
+
+    /**
+     * @brief Returns the original vertex of a core vertex.
+     */
+    Vertex<T> *toOriginal(const Vertex<T> *coreVertex) const { return originalOf[coreVertex->getIndex()]; }
+
+    /**
+     * @brief Expands a path of the core into the path of the original graph it stands for, keeping its legs
+     * and their times.
+     *
+     * @complexity O(L), where L is the length of the original path.
+     */
+    Path<T> unpack(const Path<T> &corePath) const;
+
+    /// Number of pass-through vertices replaced by shortcut edges.
+    int getNumContracted() const { return contracted; }
+    /// Number of vertices left out because they lie on dead ends (or on cycles with no core vertex).
+    int getNumPruned() const { return original.getNumVertex() - core.getNumVertex() - contracted; }
+
+private:
+    const Graph<T> &original;
+    Graph<T> core;
+    std::vector<Vertex<T> *> coreOf;     // by original vertex position
+    std::vector<Vertex<T> *> originalOf; // by core vertex position
+    std::vector<size_t> expansionStart;  // by core edge index, into expansion
+    std::vector<Edge<T> *> expansion;    // original edges of every core edge, in travel order
+    std::unordered_map<const Edge<T> *, Edge<T> *> coreEdgeOf;
+    int contracted = 0;
+
+    void addSegment(Vertex<T> *from, Vertex<T> *to, const std::vector<Edge<T> *> &forward,
+                    const std::vector<Edge<T> *> &backward);
+};
+
+/*
+ * Adds the core edges for a sequence of original edges between two core vertices, and for the sequence in
+ * the opposite direction if there is one. Equal times in both directions make a two-way segment.
+ */
+template <class T>
+void CoreGraph<T>::addSegment(Vertex<T> *from, Vertex<T> *to, const std::vector<Edge<T> *> &forward,
+                              const std::vector<Edge<T> *> &backward) {
+    // Times of a chain; a chain longer than a Weight can hold counts as impassable
+    auto total = [](const std::vector<Edge<T> *> &edges, bool driving) {
+        Distance sum = 0;
+        for (const Edge<T> *e : edges) {
+            sum = saturatingAdd(sum, toDistance(driving ? e->getDrivingTime() : e->getWalkingTime()));
+        }
+        return sum >= IMPASSABLE ? IMPASSABLE : static_cast<Weight>(sum);
+    };
+    auto record = [this](Edge<T> *coreEdge, const std::vector<Edge<T> *> &edges) {
+        expansionStart.push_back(expansion.size());
+        expansion.insert(expansion.end(), edges.begin(), edges.end());
+        if (edges.size() == 1) coreEdgeOf[edges[0]] = coreEdge;
+    };
+
+    Weight driving = total(forward, true), walking = total(forward, false);
+    if (backward.empty()) {
+        record(core.addDirectedEdge(from, to, driving, walking), forward);
+        return;
+    }
+
+    Weight backDriving = total(backward, true), backWalking = total(backward, false);
+    if (driving == backDriving && walking == backWalking) {
+        core.addEdge(from, to, driving, walking);
+        Edge<T> *e = from->getAdj().back();
+        record(e, forward);
+        record(e->getReverse(), backward);
+    } else {
+        Edge<T> *e = core.addDirectedEdge(from, to, driving, walking);
+        Edge<T> *reverse = core.addDirectedEdge(to, from, backDriving, backWalking);
+        e->setReverse(reverse);
+        reverse->setReverse(e);
+        record(e, forward);
+        record(reverse, backward);
+    }
+}
+
+template <class T>
+CoreGraph<T>::CoreGraph(const Graph<T> &g, const std::vector<const Vertex<T> *> &keep) : original(g) {
+    const std::vector<Vertex<T> *> &vertices = g.getVertexSet();
+    const size_t n = vertices.size();
+
+    // Vertices that must stay: parking, listed, and the ends of one-way edges
+    std::vector<bool> kept(n, false), removed(n, false);
+    std::vector<int> degree(n, 0);
+    for (const Vertex<T> *v : keep) kept[v->getIndex()] = true;
+    for (const Vertex<T> *v : vertices) {
+        if (v->getParking()) kept[v->getIndex()] = true;
+        for (const Edge<T> *e : v->getAdj()) {
+            if (e->getReverse() == nullptr) kept[v->getIndex()] = kept[e->getDest()->getIndex()] = true;
+        }
+        degree[v->getIndex()] = v->getAdj().size();
+    }
+
+    // Dead ends: remove vertices with at most one neighbour until there are none left
+    std::vector<int> leaves;
+    for (size_t v = 0; v < n; v++) {
+        if (!kept[v] && degree[v] <= 1) leaves.push_back(v);
+    }
+    while (!leaves.empty()) {
+        int v = leaves.back();
+        leaves.pop_back();
+        removed[v] = true;
+        for (const Edge<T> *e : vertices[v]->getAdj()) {
+            int u = e->getDest()->getIndex();
+            if (removed[u]) continue;
+            if (--degree[u] == 1 && !kept[u]) leaves.push_back(u);
+        }
+    }
+
+    // Pass-through vertices: two live edges to two different neighbours
+    auto liveEdges = [&](const Vertex<T> *v) {
+        std::vector<Edge<T> *> live;
+        for (Edge<T> *e : v->getAdj()) {
+            if (!removed[e->getDest()->getIndex()]) live.push_back(e);
+        }
+        return live;
+    };
+    std::vector<bool> passThrough(n, false);
+    for (size_t v = 0; v < n; v++) {
+        if (kept[v] || removed[v] || degree[v] != 2) continue;
+        std::vector<Edge<T> *> live = liveEdges(vertices[v]);
+        passThrough[v] = live.size() == 2 && live[0]->getDest() != live[1]->getDest()
+                         && live[0]->getDest() != vertices[v] && live[1]->getDest() != vertices[v];
+    }
+
+    GraphBuilder<T> builder(n);
+    for (size_t v = 0; v < n; v++) {
+        if (removed[v] || passThrough[v]) continue;
+        const Vertex<T> *o = vertices[v];
+        builder.addVertex(o->getInfo(), o->getLocation(), o->getCode(), o->getParking());
+        originalOf.push_back(vertices[v]);
+    }
+    builder.build(core);
+    coreOf.assign(n, nullptr);
+    for (Vertex<T> *v : core.getVertexSet()) coreOf[originalOf[v->getIndex()]->getIndex()] = v;
+
+    // Edges between core vertices stay as they are; chains become one shortcut each
+    std::vector<bool> walked(n, false);
+    for (size_t v = 0; v < n; v++) {
+        Vertex<T> *from = coreOf[v];
+        if (from == nullptr) continue;
+        for (Edge<T> *e : vertices[v]->getAdj()) {
+            int next = e->getDest()->getIndex();
+            if (removed[next]) continue;
+            Edge<T> *reverse = e->getReverse();
+
+            if (coreOf[next] != nullptr) {
+                if (reverse == nullptr) addSegment(from, coreOf[next], {e}, {});
+                else if (e->getIndex() < reverse->getIndex()) addSegment(from, coreOf[next], {e}, {reverse});
+                continue;
+            }
+            if (walked[next]) continue; // Chain already added from its other end
+
+            std::vector<Edge<T> *> forward = {e};
+            const Vertex<T> *previous = vertices[v];
+            Vertex<T> *current = e->getDest();
+            while (passThrough[current->getIndex()]) {
+                walked[current->getIndex()] = true;
+                contracted++;
+                for (Edge<T> *out : liveEdges(current)) {
+                    if (out->getDest() != previous) {
+                        forward.push_back(out);
+                        previous = current;
+                        current = out->getDest();
+                        break;
+                    }
+                }
+            }
+            if (current == vertices[v]) continue; // A loop back to the same vertex is never on a shortest path
+
+            std::vector<Edge<T> *> backward;
+            for (auto it = forward.rbegin(); it != forward.rend(); ++it) backward.push_back((*it)->getReverse());
+            addSegment(from, coreOf[current->getIndex()], forward, backward);
+        }
+    }
+    expansionStart.push_back(expansion.size());
+}
+
+template <class T>
+std::vector<Vertex<T> *> CoreGraph<T>::toCore(const std::vector<Vertex<T> *> &vertices) const {
+    std::vector<Vertex<T> *> result;
+    for (const Vertex<T> *v : vertices) {
+        if (toCore(v) != nullptr) result.push_back(toCore(v));
+    }
+    return result;
+}
+
+template <class T>
+std::vector<Edge<T> *> CoreGraph<T>::toCore(const std::vector<Edge<T> *> &edges) const {
+    std::vector<Edge<T> *> result;
+    for (const Edge<T> *e : edges) {
+        if (toCore(e) != nullptr) result.push_back(toCore(e));
+    }
+    return result;
+}
+
+template <class T>
+Path<T> CoreGraph<T>::unpack(const Path<T> &corePath) const {
+    Path<T> path;
+    for (size_t leg = 0; leg < corePath.getNumLegs(); leg++) {
+        Path<T> unpacked(originalOf[corePath.getVertices()[corePath.getLegStart(leg)]]);
+        for (size_t i = corePath.getLegStart(leg); i < corePath.getLegEnd(leg); i++) {
+            int coreEdge = corePath.getEdges()[i];
+            for (size_t j = expansionStart[coreEdge]; j < expansionStart[coreEdge + 1]; j++) {
+                unpacked.push(expansion[j], 0);
+            }
+        }
+        unpacked.setLegTime(corePath.getLegTime(leg));
+        path.append(unpacked);
+    }
+    return path;
+}
+
+#endif //CORE_GRAPH_H
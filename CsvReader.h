@@ -0,0 +1,162 @@
+/**
+ * @file CsvReader.h
+ * @brief Header file for an in-place CSV tokenizer.
+ *
+ * The tokenizer works directly on a range of bytes (typically a MappedFile) and hands out fields as
+ * pointer ranges into it, so no field is ever copied. Delimiters are located 16 bytes at a time with
+ * SSE2 when it is available.
+ */
+
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define CSV_READER_SSE2
+#endif
+
+/**
+ * @brief A field of a CSV row, pointing into the buffer being tokenized.
+ */
+struct CsvField {
+    const char *begin = nullptr;
+    const char *end = nullptr;
+
+    std::size_t size() const { return end - begin; }
+    bool empty() const { return begin == end; }
+    std::string str() const { return std::string(begin, end); }
+
+    bool operator==(const char *s) const {
+        std::size_t n = std::strlen(s);
+        return size() == n && std::memcmp(begin, s, n) == 0;
+    }
+};
+
+/**
+ * @brief Finds the first ',' or '\n' in [p, end).
+ *
+ * @return A pointer to the delimiter, or end if there is none.
+ *
+ * @complexity O(n)
+ */
+inline const char *findCsvDelimiter(const char *p, const char *end) {
+#ifdef CSV_READER_SSE2
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, newline)));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != ',' && *p != '\n') p++;
+    return p;
+}
+
+/**
+ * @brief Finds the first '\n' in [p, end).
+ */
+inline const char *findLineEnd(const char *p, const char *end) {
+    const void *nl = std::memchr(p, '\n', end - p);
+    return nl ? static_cast<const char *>(nl) : end;
+}
+
+/**
+ * @brief Parses a decimal integer, ignoring surrounding spaces.
+ *
+ * @param field The field to parse.
+ * @param out Receives the value if successful.
+ * @return True if the whole field is a valid integer, false otherwise.
+ */
+inline bool parseCsvInt(const CsvField &field, int &out) {
+    const char *p = field.begin;
+    const char *end = field.end;
+    while (p < end && *p == ' ') p++;
+    while (end > p && end[-1] == ' ') end--;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+    if (p == end) return false;
+
+    long long value = 0;
+    for (; p < end; p++) {
+        unsigned digit = static_cast<unsigned char>(*p) - '0';
+        if (digit > 9) return false;
+        value = value * 10 + digit;
+        if (value > 2147483647LL + negative) return false;
+    }
+    out = static_cast<int>(negative ? -value : value);
+    return true;
+}
+
+/**
+ * @class CsvReader
+ * @brief Splits a buffer into rows of comma-separated fields.
+ *
+ * Quoting is not supported; neither Locations.csv nor Distances.csv use it. A trailing '\r' is
+ * removed from the last field of a row and empty lines are skipped.
+ */
+class CsvReader {
+public:
+    CsvReader(const char *begin, const char *end) : p(begin), end(end) {}
+
+    /**
+     * @brief Skips the rest of the current row, e.g. a header.
+     */
+    void skipRow() {
+        p = findLineEnd(p, end);
+        if (p < end) p++;
+        line++;
+    }
+
+    /**
+     * @brief Reads the next row.
+     *
+     * @param fields Receives up to maxFields fields; any further fields of the row are ignored.
+     * @param maxFields The capacity of fields.
+     * @return The number of fields in the row (which may exceed maxFields), or 0 at the end of the buffer.
+     */
+    int readRow(CsvField *fields, int maxFields) {
+        while (p < end && (*p == '\n' || *p == '\r')) {
+            if (*p == '\n') line++;
+            p++;
+        }
+        if (p >= end) return 0;
+
+        int count = 0;
+        while (true) {
+            const char *delim = findCsvDelimiter(p, end);
+            if (count < maxFields) {
+                fields[count].begin = p;
+                fields[count].end = delim;
+            }
+            count++;
+            if (delim == end || *delim == '\n') {
+                if (count <= maxFields && delim > p && delim[-1] == '\r') fields[count - 1].end--;
+                p = delim == end ? end : delim + 1;
+                line++;
+                return count;
+            }
+            p = delim + 1;
+        }
+    }
+
+    /**
+     * @brief Returns the 1-based line number of the row read last.
+     */
+    int getLine() const { return line; }
+
+    const char *position() const { return p; }
+
+private:
+    const char *p;
+    const char *end;
+    int line = 0;
+};
+
+#endif //CSV_READER_H
@@ -0,0 +1,177 @@
+/**
+ * @file DeltaApplier.cpp
+ * @brief Implementation file for the DeltaApplier class.
+ */
+
+#include <iostream>
+
+#include "DeltaApplier.h"
+#include "CsvReader.h"
+#include "MappedFile.h"
+#include "./data_structures/GraphBuilder.h"
+
+using namespace std;
+
+bool DeltaApplier::apply(const string &file) {
+    MappedFile mapped;
+    if (!mapped.open(file)) {
+        cerr << "Error: Could not open " << file << endl;
+        return false;
+    }
+    filename = file;
+
+    CsvReader reader(mapped.data(), mapped.data() + mapped.size());
+    reader.skipRow(); // Skip header
+    CsvField fields[5];
+    int count;
+    while ((count = reader.readRow(fields, 5)) > 0) {
+        Change change{};
+        change.line = reader.getLine();
+        bool valid;
+
+        if (fields[0] == "ADD_LOCATION") {
+            change.operation = Operation::AddLocation;
+            int parking = 0;
+            valid = count >= 5 && parseCsvInt(fields[2], change.id) && parseCsvInt(fields[4], parking);
+            if (valid) {
+                change.location = fields[1].str();
+                change.code1 = fields[3].str();
+                change.parking = parking != 0;
+            }
+        } else if (fields[0] == "REMOVE_LOCATION") {
+            change.operation = Operation::RemoveLocation;
+            valid = count >= 2;
+            if (valid) change.code1 = fields[1].str();
+        } else if (fields[0] == "REMOVE_SEGMENT") {
+            change.operation = Operation::RemoveSegment;
+            valid = count >= 3;
+        } else if (fields[0] == "ADD_SEGMENT" || fields[0] == "UPDATE_SEGMENT") {
+            change.operation = (fields[0] == "ADD_SEGMENT") ? Operation::AddSegment : Operation::UpdateSegment;
+            int drivingTime = IMPASSABLE, walkingTime = 0;
+            valid = count >= 5 && parseCsvInt(fields[4], walkingTime) && isValidWeight(walkingTime);
+            if (valid && !(fields[3] == "X")) valid = parseCsvInt(fields[3], drivingTime) && isValidWeight(drivingTime);
+            change.drivingTime = static_cast<Weight>(drivingTime);
+            change.walkingTime = static_cast<Weight>(walkingTime);
+        } else {
+            reject(change.line, "unknown operation " + fields[0].str());
+            continue;
+        }
+
+        if (!valid) {
+            reject(change.line, "malformed change");
+            continue;
+        }
+        if (change.operation == Operation::AddSegment || change.operation == Operation::RemoveSegment
+            || change.operation == Operation::UpdateSegment) {
+            change.code1 = fields[1].str();
+            change.code2 = fields[2].str();
+        }
+
+        if (!pending.empty() && (pending.back().operation != change.operation || pending.size() >= batchSize)) flush();
+        pending.push_back(std::move(change));
+    }
+    flush();
+    return true;
+}
+
+void DeltaApplier::flush() {
+    if (pending.empty()) return;
+    stats.batches++;
+
+    switch (pending.front().operation) {
+        case Operation::AddLocation: {
+            GraphBuilder<int> builder(pending.size());
+            for (const Change &c : pending) builder.addVertex(c.id, c.location, c.code1, c.parking);
+            int before = graph.getNumVertex();
+            if (!builder.build(graph)) {
+                for (const string &error : builder.getErrors()) cerr << filename << ": " << error << ", skipped" << endl;
+                stats.rejected += builder.getErrors().size();
+            }
+            stats.locationsAdded += graph.getNumVertex() - before;
+            break;
+        }
+        case Operation::RemoveLocation:
+            for (const Change &c : pending) {
+                Vertex<int> *v = graph.findVertexByCode(c.code1);
+                if (v == nullptr) {
+                    reject(c.line, "unknown location " + c.code1);
+                    continue;
+                }
+                graph.removeVertex(v);
+                stats.locationsRemoved++;
+            }
+            break;
+        case Operation::AddSegment: {
+            std::vector<SegmentInput<int>> segments;
+            segments.reserve(pending.size());
+            for (const Change &c : pending) {
+                Vertex<int> *orig = graph.findVertexByCode(c.code1);
+                Vertex<int> *dest = graph.findVertexByCode(c.code2);
+                if (orig == nullptr || dest == nullptr) {
+                    reject(c.line, "unknown location in segment");
+                    continue;
+                }
+                segments.push_back(SegmentInput<int>{orig, dest, c.drivingTime, c.walkingTime});
+            }
+            stats.segmentsAdded += graph.addEdges(segments);
+            if (weights != nullptr) weights->sync();
+            break;
+        }
+        case Operation::RemoveSegment:
+            for (const Change &c : pending) {
+                Edge<int> *edge = findSegment(c);
+                if (edge == nullptr) {
+                    reject(c.line, "unknown segment " + c.code1 + "," + c.code2);
+                    continue;
+                }
+                // Only the listed segment: parallel segments between the same locations stay
+                Edge<int> *reverse = edge->getReverse();
+                graph.removeEdge(edge);
+                if (reverse != nullptr) graph.removeEdge(reverse);
+                stats.segmentsRemoved++;
+            }
+            break;
+        case Operation::UpdateSegment: {
+            std::vector<WeightUpdate<int>> batch;
+            for (const Change &c : pending) {
+                Edge<int> *edge = findSegment(c);
+                if (edge == nullptr) {
+                    reject(c.line, "unknown segment " + c.code1 + "," + c.code2);
+                    continue;
+                }
+                if (weights != nullptr) {
+                    batch.push_back(WeightUpdate<int>::setTimes(edge, c.drivingTime, c.walkingTime));
+                } else {
+                    for (Edge<int> *e : {edge, edge->getReverse()}) {
+                        if (e == nullptr) continue;
+                        e->setDrivingTime(c.drivingTime);
+                        e->setWalkingTime(c.walkingTime);
+                    }
+                }
+                stats.segmentsUpdated++;
+            }
+            if (weights != nullptr && !batch.empty()) weights->apply(batch);
+            break;
+        }
+    }
+    pending.clear();
+}
+
+void DeltaApplier::reject(int line, const string &message) {
+    cerr << filename << ":" << line << ": " << message << ", skipped" << endl;
+    stats.rejected++;
+}
+
+/*
+ * Scans the adjacency list of the origin, so a lookup costs O(degree); road network degrees are small enough
+ * that an index by location pair is not worth maintaining across removals.
+ */
+Edge<int> *DeltaApplier::findSegment(const Change &change) const {
+    Vertex<int> *orig = graph.findVertexByCode(change.code1);
+    Vertex<int> *dest = graph.findVertexByCode(change.code2);
+    if (orig == nullptr || dest == nullptr) return nullptr;
+    for (Edge<int> *e : orig->getAdj()) {
+        if (e->getDest() == dest) return e;
+    }
+    return nullptr;
+}
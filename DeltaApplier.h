@@ -0,0 +1,111 @@
+/**
+ * @file DeltaApplier.h
+ * @brief Header file for the DeltaApplier class.
+ *
+ * A delta file describes incremental changes to the network, one per line, in the same CSV style as
+ * Locations.csv and Distances.csv:
+ *
+ *     Operation,Field1,Field2,Field3,Field4
+ *     ADD_LOCATION,<Location>,<Id>,<Code>,<Parking>
+ *     REMOVE_LOCATION,<Code>
+ *     ADD_SEGMENT,<Code1>,<Code2>,<Driving>,<Walking>
+ *     REMOVE_SEGMENT,<Code1>,<Code2>
+ *     UPDATE_SEGMENT,<Code1>,<Code2>,<Driving>,<Walking>
+ *
+ * As in Distances.csv, a driving time of "X" marks a segment that can only be walked. Segments are two-way:
+ * removing or updating one affects both directions.
+ */
+
+#ifndef DELTA_APPLIER_H
+#define DELTA_APPLIER_H
+
+#include <string>
+#include <vector>
+
+#include "./data_structures/Graph.h"
+#include "./data_structures/WeightVersions.h"
+
+/**
+ * @brief Counters of what DeltaApplier::apply did.
+ */
+struct DeltaStats {
+    int locationsAdded = 0;
+    int locationsRemoved = 0;
+    int segmentsAdded = 0;
+    int segmentsRemoved = 0;
+    int segmentsUpdated = 0;
+    int rejected = 0;   ///< Lines that were malformed or referred to unknown locations or segments.
+    int batches = 0;
+};
+
+/**
+ * @class DeltaApplier
+ * @brief Streams a delta file into a live graph in batches.
+ *
+ * Consecutive changes of the same kind are grouped into batches of up to batchSize and applied together:
+ * new locations and segments go through GraphBuilder and Graph::addEdges, and only the edges a change names
+ * are touched, so the rest of the graph is never reparsed or reindexed.
+ *
+ * If a VersionedWeights is given, segment updates are published through it as one version per batch, which
+ * lets queries that are running keep their snapshot; new segments are included with VersionedWeights::sync.
+ * Without it the times stored on the edges are overwritten. Adding and removing locations or segments changes
+ * the graph structure and must not overlap with running queries.
+ */
+class DeltaApplier {
+public:
+    /**
+     * @brief Creates an applier for a graph.
+     * @param graph The graph to change.
+     * @param weights The versioned weights of the graph, or nullptr to update the edges in place.
+     * @param batchSize The maximum number of changes applied together.
+     */
+    explicit DeltaApplier(Graph<int> &graph, VersionedWeights<int> *weights = nullptr, size_t batchSize = 1024)
+        : graph(graph), weights(weights), batchSize(batchSize > 0 ? batchSize : 1) {}
+
+    /**
+     * @brief Applies all changes in a delta file, in order.
+     *
+     * Rejected lines are reported on stderr and skipped.
+     *
+     * @param filename The name of the delta file.
+     * @return True if the file could be read, false otherwise.
+     *
+     * @complexity O(C + sum of the degrees of the vertices involved), where C is the number of changes;
+     * removing a location additionally shifts the positions of the vertices after it.
+     */
+    bool apply(const std::string &filename);
+
+    /**
+     * @brief Returns the counters accumulated over all calls to apply().
+     */
+    const DeltaStats &getStats() const { return stats; }
+
+private:
+    enum class Operation { AddLocation, RemoveLocation, AddSegment, RemoveSegment, UpdateSegment };
+
+    struct Change {
+        Operation operation;
+        int line;
+        std::string location;
+        std::string code1;
+        std::string code2;
+        int id;
+        bool parking;
+        Weight drivingTime;
+        Weight walkingTime;
+    };
+
+    Graph<int> &graph;
+    VersionedWeights<int> *weights;
+    size_t batchSize;
+    DeltaStats stats;
+
+    std::string filename;
+    std::vector<Change> pending;
+
+    void flush();
+    void reject(int line, const std::string &message);
+    Edge<int> *findSegment(const Change &change) const;
+};
+
+#endif //DELTA_APPLIER_H
@@ -0,0 +1,231 @@
+/**
+ * @file GraphSnapshot.cpp
+ * @brief Implementation file for the GraphSnapshot class.
+ *
+ * This file contains the writer and the memory-mapped loader of the binary graph snapshot format.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "GraphSnapshot.h"
+#include "./data_structures/GraphBuilder.h"
+
+const uint32_t GraphSnapshot::FORMAT_VERSION;
+const uint32_t GraphSnapshot::NO_EDGE;
+
+namespace {
+
+const char MAGIC[8] = {'D', 'A', 'G', 'R', 'A', 'P', 'H', '\0'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+/*
+ * Appends the raw bytes of an array to the output buffer at the given (aligned) offset.
+ */
+template <class U>
+void put(std::vector<char> &out, uint64_t offset, const std::vector<U> &values) {
+    if (values.empty()) return;
+    std::memcpy(out.data() + offset, values.data(), values.size() * sizeof(U));
+}
+
+/*
+ * Reads the size and modification time of a file; a missing file gets a stamp no file can match.
+ */
+GraphSnapshot::SourceStamp stampOf(const std::string &filename) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return GraphSnapshot::SourceStamp{UINT64_MAX, -1};
+    return GraphSnapshot::SourceStamp{static_cast<uint64_t>(st.st_size), static_cast<int64_t>(st.st_mtime)};
+}
+
+bool sameStamp(const GraphSnapshot::SourceStamp &a, const GraphSnapshot::SourceStamp &b) {
+    return a.size != UINT64_MAX && a.size == b.size && a.modified == b.modified;
+}
+
+}
+
+bool GraphSnapshot::write(const Graph<int> &graph, const std::string &filename, const std::string &locationsFile,
+                          const std::string &distancesFile) {
+    const std::vector<Vertex<int> *> &vertices = graph.getVertexSet();
+    const uint32_t numVertices = vertices.size();
+
+    // Adjacency in CSR form, in the order the edges appear in each vertex's adjacency list
+    std::vector<uint32_t> adjOffsets(numVertices + 1, 0);
+    std::vector<uint32_t> targets;
+    std::vector<Weight> drivingTimes, walkingTimes;
+    std::unordered_map<const Edge<int> *, uint32_t> position;
+    std::vector<const Edge<int> *> edges;
+    for (uint32_t v = 0; v < numVertices; v++) {
+        adjOffsets[v] = targets.size();
+        for (Edge<int> *e : vertices[v]->getAdj()) {
+            position[e] = targets.size();
+            edges.push_back(e);
+            targets.push_back(e->getDest()->getIndex());
+            drivingTimes.push_back(e->getDrivingTime());
+            walkingTimes.push_back(e->getWalkingTime());
+        }
+    }
+    adjOffsets[numVertices] = targets.size();
+    const uint32_t numEdges = targets.size();
+
+    std::vector<uint32_t> reverseEdges(numEdges, NO_EDGE);
+    for (uint32_t i = 0; i < numEdges; i++) {
+        auto it = position.find(edges[i]->getReverse());
+        if (it != position.end()) reverseEdges[i] = it->second;
+    }
+
+    // Vertex attributes and the string table
+    std::vector<int32_t> ids(numVertices);
+    std::vector<uint8_t> parking(numVertices);
+    std::vector<uint32_t> locationOffsets(numVertices), codeOffsets(numVertices);
+    std::vector<char> strings;
+    for (uint32_t v = 0; v < numVertices; v++) {
+        ids[v] = vertices[v]->getInfo();
+        parking[v] = vertices[v]->getParking();
+
+        Symbol location = vertices[v]->getLocationSymbol();
+        locationOffsets[v] = strings.size();
+        strings.insert(strings.end(), location.c_str(), location.c_str() + location.size() + 1);
+
+        Symbol code = vertices[v]->getCodeSymbol();
+        codeOffsets[v] = strings.size();
+        strings.insert(strings.end(), code.c_str(), code.c_str() + code.size() + 1);
+    }
+
+    // Layout
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.numVertices = numVertices;
+    header.numEdges = numEdges;
+    header.stringBytes = strings.size();
+    header.locations = stampOf(locationsFile);
+    header.distances = stampOf(distancesFile);
+
+    uint64_t offset = align8(sizeof(Header));
+    auto section = [&offset](uint64_t bytes) {
+        uint64_t start = offset;
+        offset = align8(offset + bytes);
+        return start;
+    };
+    header.adjOffsets = section(adjOffsets.size() * sizeof(uint32_t));
+    header.targets = section(numEdges * sizeof(uint32_t));
+    header.drivingTimes = section(numEdges * sizeof(Weight));
+    header.walkingTimes = section(numEdges * sizeof(Weight));
+    header.reverseEdges = section(numEdges * sizeof(uint32_t));
+    header.ids = section(numVertices * sizeof(int32_t));
+    header.parking = section(numVertices * sizeof(uint8_t));
+    header.locationOffsets = section(numVertices * sizeof(uint32_t));
+    header.codeOffsets = section(numVertices * sizeof(uint32_t));
+    header.strings = section(strings.size());
+    header.fileSize = offset;
+
+    std::vector<char> out(header.fileSize, 0);
+    std::memcpy(out.data(), &header, sizeof(header));
+    put(out, header.adjOffsets, adjOffsets);
+    put(out, header.targets, targets);
+    put(out, header.drivingTimes, drivingTimes);
+    put(out, header.walkingTimes, walkingTimes);
+    put(out, header.reverseEdges, reverseEdges);
+    put(out, header.ids, ids);
+    put(out, header.parking, parking);
+    put(out, header.locationOffsets, locationOffsets);
+    put(out, header.codeOffsets, codeOffsets);
+    put(out, header.strings, strings);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(out.data(), out.size());
+    return static_cast<bool>(file);
+}
+
+bool GraphSnapshot::open(const std::string &filename) {
+    header = nullptr;
+    if (!file.open(filename) || file.size() < sizeof(Header)) return false;
+
+    const char *base = file.data();
+    const Header *h = reinterpret_cast<const Header *>(base);
+    if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != FORMAT_VERSION
+        || h->byteOrder != BYTE_ORDER_MARK || h->fileSize != file.size()) {
+        return false;
+    }
+
+    const uint64_t V = h->numVertices, E = h->numEdges;
+    auto fits = [&](uint64_t offset, uint64_t bytes) {
+        return offset % 8 == 0 && offset <= h->fileSize && bytes <= h->fileSize - offset;
+    };
+    if (!fits(h->adjOffsets, (V + 1) * 4) || !fits(h->targets, E * 4) || !fits(h->drivingTimes, E * sizeof(Weight))
+        || !fits(h->walkingTimes, E * sizeof(Weight)) || !fits(h->reverseEdges, E * 4) || !fits(h->ids, V * 4)
+        || !fits(h->parking, V) || !fits(h->locationOffsets, V * 4) || !fits(h->codeOffsets, V * 4)
+        || !fits(h->strings, h->stringBytes)) {
+        return false;
+    }
+
+    adjOffsets = reinterpret_cast<const uint32_t *>(base + h->adjOffsets);
+    targets = reinterpret_cast<const uint32_t *>(base + h->targets);
+    drivingTimes = reinterpret_cast<const Weight *>(base + h->drivingTimes);
+    walkingTimes = reinterpret_cast<const Weight *>(base + h->walkingTimes);
+    reverseEdges = reinterpret_cast<const uint32_t *>(base + h->reverseEdges);
+    ids = reinterpret_cast<const int32_t *>(base + h->ids);
+    parking = reinterpret_cast<const uint8_t *>(base + h->parking);
+    locationOffsets = reinterpret_cast<const uint32_t *>(base + h->locationOffsets);
+    codeOffsets = reinterpret_cast<const uint32_t *>(base + h->codeOffsets);
+    strings = base + h->strings;
+
+    // Everything that is later used as an index must be in range
+    if (adjOffsets[0] != 0 || adjOffsets[V] != E) return false;
+    for (uint64_t v = 0; v < V; v++) {
+        if (adjOffsets[v] > adjOffsets[v + 1]) return false;
+        if (locationOffsets[v] >= h->stringBytes || codeOffsets[v] >= h->stringBytes) return false;
+    }
+    for (uint64_t i = 0; i < E; i++) {
+        if (targets[i] >= V || (reverseEdges[i] != NO_EDGE && reverseEdges[i] >= E)) return false;
+    }
+    if (h->stringBytes > 0 && strings[h->stringBytes - 1] != '\0') return false;
+
+    header = h;
+    return true;
+}
+
+bool GraphSnapshot::isCurrent(const std::string &locationsFile, const std::string &distancesFile) const {
+    return header != nullptr && sameStamp(stampOf(locationsFile), header->locations)
+           && sameStamp(stampOf(distancesFile), header->distances);
+}
+
+void GraphSnapshot::toGraph(Graph<int> &graph) const {
+    const uint32_t V = getNumVertex(), E = getNumEdges();
+    const int first = graph.getNumVertex();
+
+    GraphBuilder<int> builder(V);
+    for (uint32_t v = 0; v < V; v++) {
+        builder.addVertex(ids[v], getLocation(v), getCode(v), getParking(v));
+    }
+    builder.build(graph);
+    const std::vector<Vertex<int> *> &vertices = graph.getVertexSet();
+    if (vertices.size() != first + V) return; // Ids already present in the graph, the edges would not line up
+
+    std::vector<Edge<int> *> edges(E);
+    for (uint32_t v = 0; v < V; v++) {
+        for (uint32_t i = adjOffsets[v]; i < adjOffsets[v + 1]; i++) {
+            edges[i] = graph.addDirectedEdge(vertices[first + v], vertices[first + targets[i]],
+                                             drivingTimes[i], walkingTimes[i]);
+        }
+    }
+    for (uint32_t i = 0; i < E; i++) {
+        if (reverseEdges[i] != NO_EDGE) edges[i]->setReverse(edges[reverseEdges[i]]);
+    }
+
+    // Two-way segments with the same times in both directions are stored once, as addEdge would
+    for (uint32_t i = 0; i < E; i++) {
+        if (reverseEdges[i] != NO_EDGE && reverseEdges[i] > i) graph.makeUndirected(edges[i]);
+    }
+}
@@ -0,0 +1,127 @@
+/**
+ * @file GraphSnapshot.h
+ * @brief Header file for the GraphSnapshot class.
+ *
+ * This file contains the declaration of a versioned binary graph format that is loaded by mapping it into memory.
+ */
+
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+
+#include "./data_structures/Graph.h"
+#include "MappedFile.h"
+
+/**
+ * @class GraphSnapshot
+ * @brief A read-only view of a graph stored in the binary snapshot format.
+ *
+ * The file starts with a fixed header followed by 8-byte aligned sections:
+ * - the adjacency in CSR form: V + 1 offsets, then E targets, driving times, walking times and reverse edges;
+ *   times are 16-bit Weights, with IMPASSABLE for segments that can only be walked;
+ * - per vertex: the Id from Locations.csv, the parking flag, and the offsets of its location name and code
+ *   in the string table;
+ * - the string table, a sequence of NUL-terminated UTF-8 strings.
+ *
+ * The header also records the size and modification time of the CSV files the snapshot was made from, so
+ * that a snapshot older than its sources can be detected with isCurrent() instead of silently used.
+ *
+ * All numbers are stored in the byte order of the machine that wrote the file; a byte order mark in the header
+ * makes a mismatch fail the load instead of producing garbage. Sections are used in place from the mapping,
+ * so opening a snapshot costs a page-in rather than a parse.
+ */
+class GraphSnapshot {
+public:
+    static const uint32_t FORMAT_VERSION = 3;   ///< Bumped whenever the layout changes.
+    static const uint32_t NO_EDGE = 0xFFFFFFFF; ///< Reverse of an edge that has none.
+
+    /**
+     * @brief Writes a graph in the snapshot format.
+     * @param graph The graph to write.
+     * @param filename The name of the file to create.
+     * @param locationsFile, distancesFile The CSV files the graph was parsed from, recorded for isCurrent().
+     * @return True if successful, false if the file could not be written.
+     */
+    static bool write(const Graph<int> &graph, const std::string &filename, const std::string &locationsFile,
+                      const std::string &distancesFile);
+
+    /**
+     * @brief Maps a snapshot file and validates its header and sections.
+     * @param filename The name of the snapshot file.
+     * @return True if successful, false if the file is missing, truncated or in another format or version.
+     */
+    bool open(const std::string &filename);
+
+    /**
+     * @brief Tells whether the CSV files still have the size and modification time recorded when the snapshot
+     * was written. A snapshot that is not current must not be used in place of them.
+     */
+    bool isCurrent(const std::string &locationsFile, const std::string &distancesFile) const;
+
+    uint32_t getNumVertex() const { return header ? header->numVertices : 0; }
+    uint32_t getNumEdges() const { return header ? header->numEdges : 0; }
+
+    /// CSR offsets: the outgoing edges of vertex v are [getAdjOffsets()[v], getAdjOffsets()[v + 1]).
+    const uint32_t *getAdjOffsets() const { return adjOffsets; }
+    const uint32_t *getTargets() const { return targets; }
+    const Weight *getDrivingTimes() const { return drivingTimes; }
+    const Weight *getWalkingTimes() const { return walkingTimes; }
+    /// Position of the opposite direction of each edge, or NO_EDGE.
+    const uint32_t *getReverseEdges() const { return reverseEdges; }
+
+    int getId(uint32_t v) const { return ids[v]; }
+    bool getParking(uint32_t v) const { return parking[v] != 0; }
+    const char *getLocation(uint32_t v) const { return strings + locationOffsets[v]; }
+    const char *getCode(uint32_t v) const { return strings + codeOffsets[v]; }
+
+    /**
+     * @brief Adds the vertices and edges of the snapshot to a graph, in the order they were written.
+     * @param graph The graph object to fill, normally empty. Nothing but the vertices is added if any Id is already in it.
+     *
+     * @complexity O(V + E)
+     */
+    void toGraph(Graph<int> &graph) const;
+
+    /*
+     * Size and modification time (seconds since the epoch) of a source file.
+     */
+    struct SourceStamp {
+        uint64_t size;
+        int64_t modified;
+    };
+
+    /*
+     * On-disk header. Section offsets are in bytes from the start of the file.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t numVertices;
+        uint32_t numEdges;
+        uint64_t stringBytes;
+        uint64_t adjOffsets, targets, drivingTimes, walkingTimes, reverseEdges;
+        uint64_t ids, parking, locationOffsets, codeOffsets, strings;
+        uint64_t fileSize;
+        SourceStamp locations, distances;
+    };
+
+private:
+    MappedFile file;
+    const Header *header = nullptr;
+
+    const uint32_t *adjOffsets = nullptr;
+    const uint32_t *targets = nullptr;
+    const Weight *drivingTimes = nullptr;
+    const Weight *walkingTimes = nullptr;
+    const uint32_t *reverseEdges = nullptr;
+    const int32_t *ids = nullptr;
+    const uint8_t *parking = nullptr;
+    const uint32_t *locationOffsets = nullptr;
+    const uint32_t *codeOffsets = nullptr;
+    const char *strings = nullptr;
+};
+
+#endif //GRAPH_SNAPSHOT_H
@@ -0,0 +1,71 @@
+/**
+ * @file MappedFile.cpp
+ * @brief Implementation file for the MappedFile class.
+ */
+
+#include "MappedFile.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_HAS_MMAP
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &filename) {
+    close();
+
+#ifdef MAPPED_FILE_HAS_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    length = static_cast<std::size_t>(st.st_size);
+    if (length > 0) {
+        void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        madvise(p, length, MADV_SEQUENTIAL);
+        begin = static_cast<const char *>(p);
+        mapped = true;
+    }
+    ::close(fd); // the mapping stays valid after the descriptor is closed
+#else
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    length = static_cast<std::size_t>(file.tellg());
+    buffer.resize(length);
+    file.seekg(0);
+    file.read(buffer.data(), length);
+    begin = length > 0 ? buffer.data() : nullptr;
+#endif
+
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef MAPPED_FILE_HAS_MMAP
+    if (mapped) munmap(const_cast<char *>(begin), length);
+#endif
+    begin = nullptr;
+    length = 0;
+    opened = false;
+    mapped = false;
+    buffer.clear();
+}
@@ -0,0 +1,54 @@
+/**
+ * @file MappedFile.h
+ * @brief Header file for the MappedFile class.
+ *
+ * This file contains the declaration of a read-only memory mapping of a whole file.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @class MappedFile
+ * @brief Maps a file read-only into memory for the lifetime of the object.
+ *
+ * On platforms without mmap the file is read into a buffer instead, so callers can always treat
+ * the contents as one contiguous range of bytes.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Maps a file, replacing any file that was mapped before.
+     * @param filename The name of the file to map.
+     * @return True if successful, false if the file could not be opened or mapped.
+     */
+    bool open(const std::string &filename);
+
+    /**
+     * @brief Unmaps the file. Pointers returned by data() become invalid.
+     */
+    void close();
+
+    bool isOpen() const { return opened; }
+    const char *data() const { return begin; }
+    std::size_t size() const { return length; }
+
+private:
+    const char *begin = nullptr;
+    std::size_t length = 0;
+    bool opened = false;
+    bool mapped = false;            // false if the contents live in buffer
+    std::vector<char> buffer;
+};
+
+#endif //MAPPED_FILE_H
@@ -16,8 +16,18 @@
 #include <fstream>
 #include <vector>
 #include <regex>
+#include <memory>
+#include <algorithm>
+#include <cctype>
 
 #include "dijkstra.h"
+#include "AlternativeRoutes.h"
+#include "CoreGraph.h"
+#include "Connectivity.h"
+#include "NearestParking.h"
+#include "ViaRouting.h"
+#include "Waypoints.h"
+#include "./data_structures/TopK.h"
 
 using namespace std;
 
@@ -66,6 +76,11 @@ public:
      */
     void alternativeEnvFriendlyRouts();
 
+    /**
+     * @brief Finds several alternative driving or walking routes.
+     */
+    void alternativeRoutes();
+
     /**
      * @brief Prints the fastest independent route.
      * @param source Pointer to the source vertex.
@@ -94,6 +109,17 @@ public:
     void printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target, std::vector<Vertex<T>*> nodesToAvoid,
         std::vector<Edge<T>*> segmentsToAvoid, Vertex<T>* includeNode);
 
+    /**
+     * @brief Prints the fastest restricted route that visits several nodes in order.
+     * @param source Pointer to the source vertex.
+     * @param target Pointer to the target vertex.
+     * @param nodesToAvoid Vector of nodes to avoid.
+     * @param segmentsToAvoid Vector of segments to avoid.
+     * @param includeNodes The nodes to include, in the order to visit them.
+     */
+    void printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target, std::vector<Vertex<T>*> nodesToAvoid,
+        std::vector<Edge<T>*> segmentsToAvoid, const std::vector<Vertex<T>*>& includeNodes);
+
     /**
      * @brief Prints the fastest environmentally friendly route.
      * @param source Pointer to the source vertex.
@@ -116,6 +142,15 @@ public:
     void printAlternativeEnvFriendlyRoutes(Vertex<T> *source, Vertex<T> *target, vector<Vertex<T> *> nodesToAvoid,
                                            vector<Edge<T> *> segmentsToAvoid, int maxWalkingTime);
 
+    /**
+     * @brief Prints alternative routes, fastest first.
+     * @param source Pointer to the source vertex.
+     * @param target Pointer to the target vertex.
+     * @param isDriving Flag to indicate if the driving time should be used.
+     * @param options How the alternatives are found and how many are shown.
+     */
+    void printAlternativeRoutes(Vertex<T>* source, Vertex<T>* target, bool isDriving, const AlternativeOptions& options);
+
     /**
      * @brief Returns the graph object.
      * @return Pointer to the graph object.
@@ -127,6 +162,104 @@ public:
 protected:
     Graph<T>* g; ///< Pointer to the graph object.
     bool batch_mode; ///< Flag to indicate if the menu is in batch mode.
+    SearchWorkspace<T> search; ///< Reused by every query, so each search only resets the vertices it reaches.
+    SearchWorkspace<T> walkingSearch; ///< Holds a reverse search while search holds a forward one.
+    Connectivity<T> drivingReach; ///< Rules out driving routes before searching; built by the first query.
+    Connectivity<T> walkingReach; ///< Rules out walking routes before searching; built by the first query.
+    NearestParking<T> nearestParking; ///< Walking time from the nearest parking place; built by the first query.
+    std::unique_ptr<CoreGraph<T>> core; ///< Core of the graph, keeping every parking place; built by the first query.
+    ViaRouter<T> viaRouter; ///< Search trees of the last restricted query with a node to include.
+    std::vector<SearchWorkspace<T>> legSearches; ///< One per thread searching the legs of a route with several stops.
+
+    /**
+     * @brief Builds drivingReach, walkingReach, nearestParking and core if they are not built yet. The graph
+     * must not change after the first query.
+     */
+    void buildQueryIndexes() {
+        if (!drivingReach.isBuilt()) drivingReach.build(*g, DrivingTime());
+        if (!walkingReach.isBuilt()) walkingReach.build(*g, WalkingTime());
+        if (!nearestParking.isBuilt()) nearestParking.build(*g, WalkingTime());
+        if (!core) core.reset(new CoreGraph<T>(*g, {}));
+    }
+
+    /**
+     * @brief A parking place an env-friendly route can use, with the times of its driving and walking legs.
+     */
+    struct ParkingCandidate {
+        Vertex<T>* parking; ///< In the original graph.
+        Distance driving;
+        Distance walking;   ///< UNREACHABLE if no walking path (within the limit) was found.
+    };
+
+    const CoreGraph<T>* queryCore = nullptr; ///< core if the last findParkingCandidates() searched it, else nullptr.
+    Vertex<T>* querySource = nullptr;        ///< Source of the last findParkingCandidates().
+    Vertex<T>* queryTarget = nullptr;        ///< Target of the last findParkingCandidates().
+
+    /*
+     * Tells whether a query can run on core: its endpoints and the vertices it avoids must be core vertices,
+     * and the segments it avoids core edges of their own rather than parts of a contracted chain.
+     */
+    bool coreCovers(const std::vector<Vertex<T>*>& vertices, const std::vector<Edge<T>*>& segments) const {
+        for (const Vertex<T> *v : vertices) {
+            if (core->toCore(v) == nullptr) return false;
+        }
+        for (const Edge<T> *e : segments) {
+            if (core->toCore(e) == nullptr) return false;
+        }
+        return true;
+    }
+
+    /// The vertex the last findParkingCandidates() searched for an original vertex.
+    Vertex<T>* searched(Vertex<T>* v) const { return queryCore ? queryCore->toCore(v) : v; }
+
+    /**
+     * @brief Finds the times of the fastest driving path to every parking place the source can drive to and
+     * of the fastest walking path from it to the target, in vertex order. Paths are only built for the
+     * candidates passed to routeThrough().
+     *
+     * The searches run on core when it holds the source, the target and everything to avoid, and on the
+     * whole graph otherwise.
+     *
+     * @param maxWalkingTime For the fastest route with at most this much walking: longer walking paths are
+     * not searched, and only the parking places that can still be part of the fastest route are returned.
+     * Without it, every parking place the source can drive to is returned.
+     */
+    void findParkingCandidates(Vertex<T>* source, Vertex<T>* target, const std::vector<Vertex<T>*>& nodesToAvoid,
+                               const std::vector<Edge<T>*>& segmentsToAvoid, std::vector<ParkingCandidate>& candidates,
+                               Distance maxWalkingTime = UNREACHABLE);
+
+    /**
+     * @brief Builds the route through a candidate of the last findParkingCandidates(): its driving leg
+     * followed by its walking leg, which must have been found.
+     *
+     * @complexity O(L), where L is the length of the route.
+     */
+    Path<T> routeThrough(const ParkingCandidate& candidate) const;
+
+    /**
+     * @brief Writes a route as in output.txt: its location names separated by commas and its time in
+     * parentheses, or "none" if no route was found.
+     */
+    void writeRoute(std::ostream &os, const Path<T> &route) const {
+        if (route.empty()) {
+            os << "none";
+            return;
+        }
+        route.render(os, *g, ",");
+        os << "(" << route.getTime() << ")";
+    }
+
+    /**
+     * @brief Prints a route on the console with its total time.
+     */
+    void printRoute(const Path<T> &route) const {
+        if (route.empty()) {
+            std::cout << "No route found." << std::endl;
+            return;
+        }
+        route.render(std::cout, *g, " -> ");
+        std::cout << "\nTotal distance: " << route.getTime() << std::endl;
+    }
 };
 
 template <class T>
@@ -205,9 +338,10 @@ template <class T>
 void Menu<T>::fastestRestrictedRoute() {
     std::vector<Vertex<T>*> nodesToAvoid = {};
     std::vector<Edge<T>*> segmentsToAvoid = {};
-    std::string source, target, includeNode;
-    int sourceID = -1, targetID = -1, includeNodeID = -1;
-    bool validSource = false, validTarget = false, validAvoidNodes = false, validAvoidSegments = false, validIncludeNode = false;
+    std::vector<Vertex<T>*> includeNodes = {};
+    std::string source, target;
+    int sourceID = -1, targetID = -1;
+    bool validSource = false, validTarget = false, validAvoidNodes = false, validAvoidSegments = false, validIncludeNodes = false;
 
     if (batch_mode) {
         std::ifstream inFile("../input.txt");
@@ -278,10 +412,19 @@ void Menu<T>::fastestRestrictedRoute() {
                 }
             }
             else if (key == "IncludeNode") {
-                std::getline(ss, includeNode);
-                if (includeNode != "none") {
-                    includeNodeID = std::stoi(includeNode);
-                    validIncludeNode = (g->findVertex(includeNodeID) != nullptr);
+                std::string nodes;
+                std::getline(ss, nodes);
+                if (nodes != "none") {
+                    std::stringstream ns(nodes);
+                    std::string node;
+                    while (std::getline(ns, node, ',')) {
+                        Vertex<T>* vertex = g->findVertex(std::stoi(node));
+                        if (vertex) {
+                            includeNodes.push_back(vertex);
+                        } else {
+                            std::cerr << "Invalid node to include: " << node << std::endl;
+                        }
+                    }
                 }
             }
         }
@@ -383,35 +526,44 @@ void Menu<T>::fastestRestrictedRoute() {
             }
 
 
-        while (!validIncludeNode) {
-            std::cout << "Please enter the node to include (type 'none' for no include node): ";
-            std::getline(std::cin, includeNode);
-            if (includeNode == "none") break;
-            Vertex<T>* includeVertex = g->findVertex(includeNode);
-            if (includeVertex != nullptr) {
-                validIncludeNode = true;
-            } else {
-                std::cout << "\nInvalid node " << includeNode << ". Please try again: ";
+        while (!validIncludeNodes) {
+            bool invalidNodes = false;
+            std::cout << "Please enter the nodes to include, in order (separated by commas, type 'none' for no include node): ";
+            std::string nodes;
+            std::getline(std::cin, nodes);
+            if (nodes == "none") break;
+            std::stringstream ss(nodes);
+            std::string node;
+            while (std::getline(ss, node, ',')) {
+                Vertex<T>* vertex = g->findVertex(node);
+                if (vertex != nullptr) {
+                    includeNodes.push_back(vertex);
+                } else {
+                    std::cout << "\nInvalid node " << node << ". Please try again: ";
+                    includeNodes.clear();
+                    invalidNodes = true;
+                    break;
+                }
             }
+            if (!invalidNodes) validIncludeNodes = true;
         }
     }
 
     Vertex<T>* sourceVertex = nullptr;
     Vertex<T>* targetVertex = nullptr;
-    Vertex<T>* includeVertex = nullptr;
 
     if (batch_mode) {
         sourceVertex = g->findVertex(sourceID);
         targetVertex = g->findVertex(targetID);
-        if (validIncludeNode) includeVertex = g->findVertex(includeNodeID);
     } else {
         sourceVertex = g->findVertex(source);
         targetVertex = g->findVertex(target);
-        if (validIncludeNode) includeVertex = g->findVertex(includeNode);
     }
 
-    if (validIncludeNode) {
-        printFastestRestrictedRoute(sourceVertex, targetVertex, nodesToAvoid, segmentsToAvoid, includeVertex);
+    if (includeNodes.size() > 1) {
+        printFastestRestrictedRoute(sourceVertex, targetVertex, nodesToAvoid, segmentsToAvoid, includeNodes);
+    } else if (includeNodes.size() == 1) {
+        printFastestRestrictedRoute(sourceVertex, targetVertex, nodesToAvoid, segmentsToAvoid, includeNodes[0]);
     } else {
         printFastestRestrictedRoute(sourceVertex, targetVertex, nodesToAvoid, segmentsToAvoid);
     }
@@ -827,22 +979,182 @@ void Menu<T>::alternativeEnvFriendlyRouts() {
     printAlternativeEnvFriendlyRoutes(sourceVertex, targetVertex, nodesToAvoid, segmentsToAvoid, maxWalkingTime);
 }
 
+template <class T>
+void Menu<T>::alternativeRoutes() {
+    AlternativeOptions options;
+    bool isDriving = true;
+    Vertex<T>* sourceVertex = nullptr;
+    Vertex<T>* targetVertex = nullptr;
+    long count = static_cast<long>(options.count); // Read signed, so that a negative count is clamped, not wrapped
+
+    // Reads "driving" or "walking", ignoring case and surrounding blanks; false for anything else
+    auto parseMode = [](std::string value, bool &driving) {
+        value.erase(0, value.find_first_not_of(" \t\r"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+        std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (value != "driving" && value != "walking") return false;
+        driving = value == "driving";
+        return true;
+    };
+    // Reads a whole value as a number, ignoring surrounding blanks; false if it is not one
+    auto parseNumber = [](const std::string &value, auto &number) {
+        std::istringstream in(value);
+        return (in >> number) && (in >> std::ws).eof();
+    };
+
+    if (batch_mode) {
+        std::ifstream inputFile("../input.txt");
+        if (!inputFile.is_open()) {
+            std::cerr << "Error: Could not open input.txt\n";
+            return;
+        }
+        int sourceID = -1, targetID = -1;
+        bool valid = true;
+        std::string line;
+        while (std::getline(inputFile, line)) {
+            std::istringstream iss(line);
+            std::string key, value;
+            if (std::getline(iss, key, ':') && std::getline(iss, value)) {
+                value.erase(0, value.find_first_not_of(" \t"));
+                if (key == "Source") {
+                    valid = parseNumber(value, sourceID) && valid;
+                } else if (key == "Destination") {
+                    valid = parseNumber(value, targetID) && valid;
+                } else if (key == "Mode") {
+                    valid = parseMode(value, isDriving) && valid;
+                } else if (key == "Alternatives") {
+                    valid = parseNumber(value, count) && valid;
+                } else if (key == "Method") {
+                    options.method = value == "penalty" ? AlternativeOptions::PENALTY : AlternativeOptions::YEN;
+                } else if (key == "MaxSimilarity") {
+                    valid = parseNumber(value, options.maxSimilarity) && valid;
+                }
+            }
+        }
+        inputFile.close();
+
+        sourceVertex = g->findVertex(sourceID);
+        targetVertex = g->findVertex(targetID);
+        if (sourceVertex == nullptr || targetVertex == nullptr || !valid) {
+            std::cerr << "Error: Invalid input format in input.txt\n";
+            return;
+        }
+    }
+    else {
+        std::string source, target, mode, input, method;
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+        while (sourceVertex == nullptr && std::cin) {
+            std::cout << "Please enter the source vertex: ";
+            std::getline(std::cin, source);
+            sourceVertex = g->findVertex(source);
+            if (sourceVertex == nullptr) std::cout << "\nInvalid source vertex. Please try again: ";
+        }
+
+        while (targetVertex == nullptr && std::cin) {
+            std::cout << "Please enter the target vertex: ";
+            std::getline(std::cin, target);
+            targetVertex = g->findVertex(target);
+            if (targetVertex == nullptr) std::cout << "\nInvalid target vertex. Please try again: ";
+        }
+        if (!std::cin) return; // Input ended before both vertices were found
+
+        std::cout << "Please enter the mode (driving or walking): ";
+        std::getline(std::cin, mode);
+        while (!parseMode(mode, isDriving) && std::cin) {
+            std::cout << "\nInvalid mode. Please enter driving or walking: ";
+            std::getline(std::cin, mode);
+        }
+
+        std::cout << "Please enter the number of routes (3 to 5 recommended): ";
+        std::getline(std::cin, input);
+        while (!parseNumber(input, count) && std::cin) {
+            std::cout << "\nInvalid number. Please try again: ";
+            std::getline(std::cin, input);
+        }
+
+        std::cout << "Please enter the method (yen or penalty): ";
+        std::getline(std::cin, method);
+        options.method = method == "penalty" ? AlternativeOptions::PENALTY : AlternativeOptions::YEN;
+
+        std::cout << "Please enter the largest share of time a route may share with a faster one (0 to 1): ";
+        std::getline(std::cin, input);
+        while (!parseNumber(input, options.maxSimilarity) && std::cin) {
+            std::cout << "\nInvalid number. Please try again: ";
+            std::getline(std::cin, input);
+        }
+        if (!std::cin) return; // Input ended before every value was read
+    }
+    options.count = std::max(1L, count);
+    options.maxSimilarity = std::min(1.0, std::max(0.0, options.maxSimilarity));
+
+    printAlternativeRoutes(sourceVertex, targetVertex, isDriving, options);
+}
+
+template <class T>
+void Menu<T>::printAlternativeRoutes(Vertex<T>* source, Vertex<T>* target, bool isDriving,
+                                     const AlternativeOptions& options) {
+    buildQueryIndexes();
+
+    std::vector<Path<T>> routes;
+    if ((isDriving ? drivingReach : walkingReach).connected(source, target)) {
+        routes = isDriving ? findAlternativeRoutes(g, source, target, DrivingTime(), options, search, walkingSearch)
+                           : findAlternativeRoutes(g, source, target, WalkingTime(), options, search, walkingSearch);
+    }
+
+    if (batch_mode) {
+        std::ofstream outFile("../output.txt");
+        if (!outFile) {
+            std::cerr << "Error opening output.txt" << std::endl;
+            return;
+        }
+
+        outFile << "Source:" << source->getLocation() << "\n";
+        outFile << "Destination:" << target->getLocation() << "\n";
+        for (size_t i = 0; i < routes.size(); i++) {
+            outFile << "Route" << i + 1 << ":";
+            writeRoute(outFile, routes[i]);
+            outFile << "\n";
+        }
+        if (routes.empty()) outFile << "Route1:none\n";
+
+        std::cout << "Successfully written result to output.txt" << std::endl;
+        outFile.close();
+    } else {
+        std::cout << "Alternative " << (isDriving ? "Driving" : "Walking") << " Routes from " << source->getLocation()
+                  << " to " << target->getLocation() << std::endl;
+
+        if (routes.empty()) printRoute(Path<T>());
+        for (size_t i = 0; i < routes.size(); i++) {
+            std::cout << "Route " << i + 1 << ": ";
+            printRoute(routes[i]);
+        }
+    }
+}
+
 template <class T>
 void Menu<T>::printFastestIndependantRoute(Vertex<T>* source, Vertex<T>* target) {
+    buildQueryIndexes();
 
     std::vector<Vertex<T>*> avoidNodes = {};
+    Path<T> res, res2;
 
-    dijkstra(g, source->getLocation(), {}, {}, true);
+    if (drivingReach.connected(source, target)) {
+        dijkstra(g, source, {}, {}, DrivingTime(), search);
 
-    std::pair<std::vector<string>, int> res = getPath(g, source->getLocation(), target->getLocation());
+        res = extractPath(search, source, target);
 
-    for (int i = 1; i < res.first.size() - 1; i++) {
-        avoidNodes.push_back(g->findVertex(res.first[i]));
-    }
+        for (size_t i = 1; i + 1 < res.size(); i++) {
+            avoidNodes.push_back(res.getVertex(*g, i));
+        }
 
-    dijkstra(g, source->getLocation(), avoidNodes, {}, true);
+        // No alternative if the best route passes through a vertex every route needs
+        if (!drivingReach.cutOff(source, target, avoidNodes, {})) {
+            dijkstra(g, source, avoidNodes, {}, DrivingTime(), search);
 
-    std::pair<std::vector<std::string>, int> res2 = getPath(g, source->getLocation(), target->getLocation());
+            res2 = extractPath(search, source, target);
+        }
+    }
 
     if (batch_mode) {
         std::ofstream outFile("../output.txt");
@@ -851,51 +1163,38 @@ void Menu<T>::printFastestIndependantRoute(Vertex<T>* source, Vertex<T>* target)
         outFile << "Destination:" << target->getLocation() << "\n";
 
         outFile << "BestDrivingRoute:";
-        for (size_t i = 0; i < res.first.size(); ++i) {
-            outFile << res.first[i];
-            if (i != res.first.size() - 1) outFile << ",";
-        }
-        outFile << "(" << res.second << ")\n";
+        writeRoute(outFile, res);
+        outFile << "\n";
 
         outFile << "AlternativeDrivingRoute:";
-        for (size_t i = 0; i < res2.first.size(); ++i) {
-            outFile << res2.first[i];
-            if (i != res2.first.size() - 1) outFile << ",";
-        }
-        outFile << "(" << res2.second << ")\n";
+        writeRoute(outFile, res2);
+        outFile << "\n";
         std::cout << "Successfully written result to output.txt" << std::endl;
 
         outFile.close();
     } else {
         std::cout << "Fastest Independent Route from " << source->getLocation() << " to " << target->getLocation() << std::endl;
 
-        for (size_t i = 0; i < res.first.size(); ++i) {
-            std::cout << res.first[i];
-            if (i != res.first.size() - 1) {
-                std::cout << " -> ";
-            }
-        }
-        std::cout << "\nTotal distance: " << res.second << std::endl << std::endl;
+        printRoute(res);
+        std::cout << std::endl;
 
         std::cout << "Fastest Alternative Independent Route from " << source->getLocation() << " to " << target->getLocation() << std::endl;
 
-        for (size_t i = 0; i < res2.first.size(); ++i) {
-            std::cout << res2.first[i];
-            if (i != res2.first.size() - 1) {
-                std::cout << " -> ";
-            }
-        }
-        std::cout << "\nTotal distance: " << res2.second << std::endl;
+        printRoute(res2);
     }
 }
 
 template <class T>
 void Menu<T>::printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target, std::vector<Vertex<T>*> nodesToAvoid,
     std::vector<Edge<T>*> segmentsToAvoid) {
+    buildQueryIndexes();
 
-    dijkstra(g, source->getLocation(), nodesToAvoid, segmentsToAvoid, true);
+    Path<T> res;
+    if (!drivingReach.cutOff(source, target, nodesToAvoid, segmentsToAvoid)) {
+        dijkstra(g, source, nodesToAvoid, segmentsToAvoid, DrivingTime(), search);
 
-    std::pair<std::vector<string>, int> res = getPath(g, source->getLocation(), target->getLocation());
+        res = extractPath(search, source, target);
+    }
     if (batch_mode) {
         std::ofstream outFile("../output.txt");
         if (!outFile) {
@@ -906,15 +1205,8 @@ void Menu<T>::printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target,
         outFile << "Source:" << source->getLocation() << "\n";
         outFile << "Destination:" << target->getLocation() << "\n";
         outFile << "RestrictedDrivingRoute:";
-
-        for (size_t i = 0; i < res.first.size(); ++i) {
-            outFile << res.first[i];
-            if (i != res.first.size() - 1) {
-                outFile << ",";
-            }
-        }
-
-        outFile << "(" << res.second << ")\n";
+        writeRoute(outFile, res);
+        outFile << "\n";
 
         std::cout << "Successfully written result to output.txt" << std::endl;
         outFile.close();
@@ -923,35 +1215,24 @@ void Menu<T>::printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target,
     else {
         std::cout << "Fastest Restricted Route from " << source->getLocation() << " to " << target->getLocation() << std::endl;
 
-        for (size_t i = 0; i < res.first.size(); ++i) {
-            std::cout << res.first[i];
-            if (i != res.first.size() - 1) {
-                std::cout << " -> ";
-            }
-        }
-
-        std::cout << "\nTotal distance: " << res.second << std::endl;
+        printRoute(res);
     }
 }
 
 template <class T>
 void Menu<T>::printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target, std::vector<Vertex<T>*> nodesToAvoid,
     std::vector<Edge<T>*> segmentsToAvoid, Vertex<T>* includeNode) {
-    int totaldist = 0;
-
-    dijkstra(g, source->getLocation(), nodesToAvoid, segmentsToAvoid, true);
 
-    std::pair<std::vector<string>, int> res = getPath(g, source->getLocation(), includeNode->getLocation());
-    totaldist += res.second;
+    buildQueryIndexes();
 
-    dijkstra(g, includeNode->getLocation(), nodesToAvoid, segmentsToAvoid, true);
+    Path<T> res;
+    if (!drivingReach.cutOff(source, includeNode, nodesToAvoid, segmentsToAvoid)
+        && !drivingReach.cutOff(includeNode, target, nodesToAvoid, segmentsToAvoid)) {
+        viaRouter.build(g, source, target, nodesToAvoid, segmentsToAvoid, DrivingTime());
 
-    std::pair<std::vector<string>, int> secondPath = getPath(g, includeNode->getLocation(), target->getLocation());
-    totaldist += secondPath.second;
-
-    for (size_t i = 1; i < secondPath.first.size(); ++i) {
-        res.first.push_back(secondPath.first[i]);
+        res = viaRouter.getRoute(includeNode); // Empty if no route passes through includeNode
     }
+
     if (batch_mode) {
         std::ofstream outFile("../output.txt");
         if (!outFile) {
@@ -962,15 +1243,8 @@ void Menu<T>::printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target,
         outFile << "Source:" << source->getLocation() << "\n";
         outFile << "Destination:" << target->getLocation() << "\n";
         outFile << "RestrictedDrivingRoute:";
-
-        for (size_t i = 0; i < res.first.size(); ++i) {
-            outFile << res.first[i];
-            if (i != res.first.size() - 1) {
-                outFile << ",";
-            }
-        }
-
-        outFile << "(" << totaldist << ")\n";
+        writeRoute(outFile, res);
+        outFile << "\n";
 
         std::cout << "Successfully written result to output.txt" << std::endl;
         outFile.close();
@@ -978,80 +1252,161 @@ void Menu<T>::printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target,
     } else {
         std::cout << "Fastest Restricted Route from " << source->getLocation() << " to " << includeNode->getLocation() << std::endl;
 
-        for (size_t i = 0; i < res.first.size(); ++i) {
-            std::cout << res.first[i];
-            if (i != res.first.size() - 1) {
-                std::cout << " -> ";
-            }
-        }
+        printRoute(res);
     }
-    std::cout << "\nTotal distance: " << totaldist << std::endl;
 }
 
 template <class T>
-void Menu<T>::printFastestEnvFriendlyRoute(Vertex<T>* source, Vertex<T>* target, std::vector<Vertex<T>*> nodesToAvoid,
-                                 std::vector<Edge<T>*> segmentsToAvoid, int maxWalkingTime) {
-    std::string origin = source->getLocation();
-    std::string destination = target->getLocation();
+void Menu<T>::printFastestRestrictedRoute(Vertex<T>* source, Vertex<T>* target, std::vector<Vertex<T>*> nodesToAvoid,
+    std::vector<Edge<T>*> segmentsToAvoid, const std::vector<Vertex<T>*>& includeNodes) {
+
+    buildQueryIndexes();
 
-    dijkstra(g, origin, nodesToAvoid, segmentsToAvoid, true); // Running dijkstra to get the shortest paths to each parking node
+    std::vector<Vertex<T>*> stops = {source};
+    stops.insert(stops.end(), includeNodes.begin(), includeNodes.end());
+    stops.push_back(target);
+
+    bool cutOff = false;
+    for (size_t i = 0; i + 1 < stops.size() && !cutOff; i++) {
+        cutOff = drivingReach.cutOff(stops[i], stops[i + 1], nodesToAvoid, segmentsToAvoid);
+    }
 
-    std::vector<std::tuple<std::vector<std::string>, int, std::string>> driving_paths;
-    for (Vertex<T> *v : g->getVertexSet()) { // Building the shortest driving paths (the ones who end in a node with parking)
-        if (v->getParking() && v != g->findVertex(origin)) {
-            std::pair<std::vector<std::string>, int> path = getPath(g, origin, v->getLocation());
-            driving_paths.push_back(std::make_tuple(path.first, path.second, v->getLocation()));
+    Path<T> res;
+    if (!cutOff) {
+        res = routeThroughStops(g, stops, nodesToAvoid, segmentsToAvoid, DrivingTime(), legSearches);
+    }
+
+    if (batch_mode) {
+        std::ofstream outFile("../output.txt");
+        if (!outFile) {
+            std::cerr << "Error opening output.txt" << std::endl;
+            return;
         }
+
+        outFile << "Source:" << source->getLocation() << "\n";
+        outFile << "Destination:" << target->getLocation() << "\n";
+        outFile << "RestrictedDrivingRoute:";
+        writeRoute(outFile, res);
+        outFile << "\n";
+
+        std::cout << "Successfully written result to output.txt" << std::endl;
+        outFile.close();
+
+    } else {
+        std::cout << "Fastest Restricted Route from " << source->getLocation() << " to " << target->getLocation()
+                  << " through " << includeNodes.size() << " stops" << std::endl;
+
+        printRoute(res);
     }
+}
 
-    std::vector<std::pair<std::vector<std::string>, int>> walking_paths;
-    for (const auto& driving_path: driving_paths) { // Building the shortest walking paths starting in a parking node
-        const std::vector<std::string>& pathNodes = std::get<0>(driving_path);
-        std::string parkingNode = pathNodes.back();
-        dijkstra(g, parkingNode, nodesToAvoid, segmentsToAvoid, false); // Running dijkstra to get the shortest paths form each parking node to the destination
+/*
+ * Joins the driving path to a parking place with the walking path from it, as the driving and walking legs
+ * of one route. Both paths must have been found (not be empty).
+ */
+template <class T>
+Path<T> joinEnvFriendlyLegs(const Path<T> &driving, const Path<T> &walking) {
+    Path<T> route = driving;
+    route.append(walking);
+    return route;
+}
 
-        std::pair<std::vector<std::string>, int> path = getPath(g, parkingNode, destination);
-        walking_paths.push_back(path);
+template <class T>
+void Menu<T>::findParkingCandidates(Vertex<T>* source, Vertex<T>* target, const std::vector<Vertex<T>*>& nodesToAvoid,
+                                    const std::vector<Edge<T>*>& segmentsToAvoid,
+                                    std::vector<ParkingCandidate>& candidates, Distance maxWalkingTime) {
+    buildQueryIndexes();
+
+    std::vector<Vertex<T>*> endpoints = nodesToAvoid;
+    endpoints.push_back(source);
+    endpoints.push_back(target);
+    queryCore = coreCovers(endpoints, segmentsToAvoid) ? core.get() : nullptr;
+    querySource = source;
+    queryTarget = target;
+    Graph<T> *searchGraph = queryCore ? &core->getGraph() : g;
+    std::vector<Vertex<T>*> searchNodesToAvoid = queryCore ? queryCore->toCore(nodesToAvoid) : nodesToAvoid;
+    std::vector<Edge<T>*> searchSegmentsToAvoid = queryCore ? queryCore->toCore(segmentsToAvoid) : segmentsToAvoid;
+    Vertex<T> *searchSource = searched(source), *searchTarget = searched(target);
+
+    // Shortest walking paths from every parking node to the destination, from one search backwards from it.
+    // Skipped when even the nearest parking place is too far away.
+    if (nearestParking.getTime(target) <= maxWalkingTime) {
+        reverseDijkstra(searchGraph, searchTarget, searchNodesToAvoid, searchSegmentsToAvoid, WalkingTime(),
+                        walkingSearch, maxWalkingTime);
+    } else {
+        walkingSearch.reset(*searchGraph); // Every parking node reads as too far
     }
 
-    std::vector<std::tuple<std::vector<std::string>, int, std::string>> possible_paths;
-    std::vector<int> walking_times;
-    for (const auto& driving_path: driving_paths) { // Combining the times of the valid driving + walking paths
-        const std::vector<std::string>& drivingPathNodes = std::get<0>(driving_path);
-        std::string parkingNode = drivingPathNodes.back();
-        const int drivingTime = std::get<1>(driving_path);
-
-        for (const auto& walking_path: walking_paths) {
-            const std::vector<std::string>& walkingPathNodes = walking_path.first;
-            std::string startingWalkingNode = walkingPathNodes.front();
-            const int walkingTime = walking_path.second;
-
-            if (startingWalkingNode == parkingNode && walkingTime <= maxWalkingTime && walkingTime > 0) { // Not accepting paths with no walking
-                std::vector<std::string> fullPath = drivingPathNodes;  // Start with the driving path
-                fullPath.insert(fullPath.end(), walkingPathNodes.begin()+1, walkingPathNodes.end());
-
-                int fullPathTime = drivingTime + walkingTime;
-                possible_paths.emplace_back(fullPath, fullPathTime, parkingNode);
-                walking_times.push_back(walkingTime);
-            }
+    // Shortest driving paths to each parking node, settled in order of driving time. With a walking limit,
+    // parking nodes are candidates in best-first order of their total time, and the search stops once the
+    // driving time alone reaches the best total: every parking node left would give a slower route.
+    Distance bestTotal = UNREACHABLE;
+    auto evaluate = [&](const Vertex<T> *v, Distance driving) {
+        if (driving >= bestTotal) return false;
+        Distance walking = walkingSearch.getDist(v);
+        if (v->getParking() && v != searchSource && walking != UNREACHABLE && walking > 0) {
+            bestTotal = std::min(bestTotal, saturatingAdd(driving, walking));
         }
+        return true;
+    };
+    if (maxWalkingTime == UNREACHABLE) {
+        dijkstra(searchGraph, searchSource, searchNodesToAvoid, searchSegmentsToAvoid, DrivingTime(), search);
+    } else {
+        dijkstra(searchGraph, searchSource, searchNodesToAvoid, searchSegmentsToAvoid, DrivingTime(), search,
+                 UNREACHABLE, evaluate);
     }
 
-    std::tuple<std::vector<std::string>, int, std::string> shortestPath;
-    int minTime = 999;
-    int maxWalkingTimeInTie = -1;
-    for (size_t i = 0; i < possible_paths.size(); ++i) { // Finding the shortest total path
-        const auto& path = possible_paths[i];
-        int currentTime = std::get<1>(path);
-        int currentWalkingTime = walking_times[i];
-        if (currentTime < minTime || (currentTime == minTime && currentWalkingTime > maxWalkingTimeInTie)) {
-            shortestPath = path;
-            minTime = currentTime;
-            maxWalkingTimeInTie = currentWalkingTime;
+    for (Vertex<T> *v : g->getVertexSet()) {
+        Vertex<T> *parking = searched(v);
+        if (v->getParking() && parking != searchSource && search.isVisited(parking)) {
+            candidates.push_back(ParkingCandidate{v, search.getDist(parking), walkingSearch.getDist(parking)});
         }
     }
+}
+
+template <class T>
+Path<T> Menu<T>::routeThrough(const ParkingCandidate& candidate) const {
+    Vertex<T> *parking = searched(candidate.parking);
+    Path<T> driving = extractPath(search, searched(querySource), parking);
+    Path<T> walking = extractReversePath(walkingSearch, parking, searched(queryTarget));
+    if (queryCore) {
+        driving = queryCore->unpack(driving);
+        walking = queryCore->unpack(walking);
+    }
+    return joinEnvFriendlyLegs(driving, walking);
+}
+
+
+template <class T>
+void Menu<T>::printFastestEnvFriendlyRoute(Vertex<T>* source, Vertex<T>* target, std::vector<Vertex<T>*> nodesToAvoid,
+                                 std::vector<Edge<T>*> segmentsToAvoid, int maxWalkingTime) {
+    std::string origin = source->getLocation();
+    std::string destination = target->getLocation();
+
+    // Clamped rather than converted, since a 16-bit Distance (DA_DISTANCE_BITS=16) would wrap large limits around;
+    // UNREACHABLE itself would mean no limit to findParkingCandidates()
+    const Distance walkingLimit = maxWalkingTime < 0 ? 0 : std::min<long long>(maxWalkingTime, UNREACHABLE - 1);
+    std::vector<ParkingCandidate> candidates;
+    findParkingCandidates(source, target, nodesToAvoid, segmentsToAvoid, candidates, walkingLimit);
+
+    // Keeping the shortest of the valid routes, preferring more walking on ties, and building only its path
+    auto faster = [](const ParkingCandidate& a, const ParkingCandidate& b) {
+        Distance timeA = saturatingAdd(a.driving, a.walking), timeB = saturatingAdd(b.driving, b.walking);
+        return timeA != timeB ? timeA < timeB : a.walking > b.walking;
+    };
+    BoundedHeap<ParkingCandidate, decltype(faster)> fastest(1, faster);
+    for (const ParkingCandidate& c : candidates) {
+        if (c.walking != UNREACHABLE && c.walking <= walkingLimit && c.walking > 0) { // Not accepting paths with no walking
+            fastest.offer(c);
+        }
+    }
+    Path<T> shortestPath;
+    if (fastest.size() > 0) shortestPath = routeThrough(fastest.take().front());
+
+    if (!shortestPath.empty()) {
+        size_t parking = shortestPath.getLegStart(1);
+        Vertex<T> *parkingNode = shortestPath.getVertex(*g, parking);
 
-    if (!possible_paths.empty()) {
         if (batch_mode) {
             std::ofstream outputFile("../output.txt");
 
@@ -1060,67 +1415,53 @@ void Menu<T>::printFastestEnvFriendlyRoute(Vertex<T>* source, Vertex<T>* target,
 
             // Driving Route
             outputFile << "DrivingRoute:";
-            for (const auto& node : std::get<0>(shortestPath)) {
-                if (node != std::get<2>(shortestPath)) {
-                    outputFile << node << ",";
-                } else {
-                    break;
-                }
-            }
-            outputFile.seekp(-1, std::ios_base::cur); // Remove last comma
-            outputFile << "(" << std::get<1>(shortestPath) << ")\n";
+            shortestPath.render(outputFile, *g, ",", 0, parking);
+            outputFile << "(" << shortestPath.getTime() << ")\n";
 
             // Parking Node
-            outputFile << "ParkingNode:" << std::get<2>(shortestPath) << "\n";
+            outputFile << "ParkingNode:" << parkingNode->getLocationSymbol() << "\n";
 
             // Walking Route
             outputFile << "WalkingRoute:";
-            bool walkingPhase = false;
-            for (const auto& node : std::get<0>(shortestPath)) {
-                if (node == std::get<2>(shortestPath)) walkingPhase = true;
-                if (walkingPhase) {
-                    outputFile << node << ",";
-                }
-            }
-            outputFile.seekp(-1, std::ios_base::cur);
-            outputFile << "(" << std::get<1>(shortestPath) << ")\n";
+            shortestPath.render(outputFile, *g, ",", parking, shortestPath.size());
+            outputFile << "(" << shortestPath.getTime() << ")\n";
 
-            outputFile << "TotalTime:" << std::get<1>(shortestPath) << "\n";
+            outputFile << "TotalTime:" << shortestPath.getTime() << "\n";
 
             outputFile.close();
         }
         else {
             std::cout << "Driving Route: ";
-            for (const auto& node : std::get<0>(shortestPath)) {
-                if (node != std::get<2>(shortestPath)) {
-                    std::cout << node << " -> ";
-                }
-                else break;
-            }
-            std::cout << std::get<2>(shortestPath) << std::endl;
+            shortestPath.render(std::cout, *g, " -> ", 0, parking + 1);
+            std::cout << std::endl;
 
-            std::cout << "Parking Node: " << std::get<2>(shortestPath) << "\n";
+            std::cout << "Parking Node: " << parkingNode->getLocationSymbol() << "\n";
 
             std::cout << "Walking Route: ";
-            bool walkingPhase = false;
-            for (const auto& node : std::get<0>(shortestPath)) {
-                if (node == std::get<2>(shortestPath)) walkingPhase = true;
-                if (walkingPhase) {
-                    std::cout << node;
-                    if (node != destination) std::cout << " -> ";
-                }
-            }
+            shortestPath.render(std::cout, *g, " -> ", parking, shortestPath.size());
             std::cout << "\n";
 
-            std::cout << "Total Time: " << std::get<1>(shortestPath) << " minutes\n";
+            std::cout << "Total Time: " << shortestPath.getTime() << " minutes\n";
         }
     }
     else {
+        // Walking times were only searched up to the limit, so telling a longer walk apart from no walk at all
+        // takes one more search, without the limit
+        bool noParking = std::none_of(candidates.begin(), candidates.end(),
+                                      [](const ParkingCandidate& c) { return c.driving != UNREACHABLE; });
+        bool noWalking = noParking;
+        if (!noParking) {
+            reverseDijkstra(g, target, nodesToAvoid, segmentsToAvoid, WalkingTime(), walkingSearch);
+            noWalking = std::none_of(candidates.begin(), candidates.end(), [this](const ParkingCandidate& c) {
+                return walkingSearch.getDist(c.parking) != UNREACHABLE;
+            });
+        }
+
         std::string message = "No valid route found within the given constraints.";
-        if (driving_paths.empty())
+        if (noParking)
             message += " No available parking within reach.";
 
-        if (walking_paths.empty())
+        if (noWalking)
             message += " No walking path found to the destination.";
 
         else message += " All walking times exceed the maximum allowed.";
@@ -1147,42 +1488,19 @@ void Menu<T>::printAlternativeEnvFriendlyRoutes(Vertex<T>* source, Vertex<T>* ta
     std::string origin = source->getLocation();
     std::string destination = target->getLocation();
 
-    dijkstra(g, origin, nodesToAvoid, segmentsToAvoid, true);
+    std::vector<ParkingCandidate> candidates;
+    findParkingCandidates(source, target, nodesToAvoid, segmentsToAvoid, candidates);
 
-    std::vector<std::tuple<std::vector<std::string>, int, std::string>> driving_paths;
-    for (Vertex<T> *v : g->getVertexSet()) {
-        if (v->getParking() && v != g->findVertex(origin)) {
-            auto path = getPath(g, origin, v->getLocation());
-            driving_paths.emplace_back(path.first, path.second, v->getLocation());
-        }
-    }
-
-    std::vector<std::pair<std::vector<std::string>, int>> walking_paths;
-    for (const auto& driving_path : driving_paths) {
-        std::string parkingNode = std::get<0>(driving_path).back();
-        dijkstra(g, parkingNode, nodesToAvoid, segmentsToAvoid, false);
-
-        auto path = getPath(g, parkingNode, destination);
-        walking_paths.push_back(path);
+    // The two fastest routes whose walking exceeds the limit; only their paths are built
+    auto faster = [](const ParkingCandidate& a, const ParkingCandidate& b) {
+        return saturatingAdd(a.driving, a.walking) < saturatingAdd(b.driving, b.walking);
+    };
+    BoundedHeap<ParkingCandidate, decltype(faster)> fastest(2, faster);
+    for (const ParkingCandidate& c : candidates) {
+        if (c.walking != UNREACHABLE && (long long) c.walking > maxWalkingTime) fastest.offer(c);
     }
-
-    std::vector<std::tuple<std::vector<std::string>, int, std::string>> alternativePaths;
-    std::vector<int> walking_times;
-    for (size_t i = 0; i < driving_paths.size(); ++i) {
-        int walkingTime = walking_paths[i].second;
-        if (walkingTime > maxWalkingTime) {
-            std::vector<std::string> fullPath = std::get<0>(driving_paths[i]);
-            fullPath.insert(fullPath.end(), walking_paths[i].first.begin() + 1, walking_paths[i].first.end());
-
-            int totalTime = std::get<1>(driving_paths[i]) + walkingTime;
-            alternativePaths.emplace_back(fullPath, totalTime, std::get<2>(driving_paths[i]));
-            walking_times.push_back(walkingTime);
-        }
-    }
-
-    std::sort(alternativePaths.begin(), alternativePaths.end(), [](const auto& a, const auto& b) {
-        return std::get<1>(a) < std::get<1>(b);
-    });
+    std::vector<Path<T>> alternativePaths;
+    for (const ParkingCandidate& c : fastest.take()) alternativePaths.push_back(routeThrough(c));
 
     if (alternativePaths.size() >= 2) {
         if (batch_mode) {
@@ -1192,34 +1510,23 @@ void Menu<T>::printAlternativeEnvFriendlyRoutes(Vertex<T>* source, Vertex<T>* ta
             outputFile << "Destination:" << destination << "\n";
 
             for (size_t i = 0; i < 2; i++) {
-                auto bestPath = alternativePaths[i];
+                const Path<T>& bestPath = alternativePaths[i];
+                size_t parking = bestPath.getLegStart(1);
 
                 // Driving Route
                 outputFile << "DrivingRoute" << i + 1 << ":";
-                for (const auto& node : std::get<0>(bestPath)) {
-                    if (node != std::get<2>(bestPath)) {
-                        outputFile << node << ",";
-                    } else break;
-                }
-                outputFile.seekp(-1, std::ios_base::cur);
-                outputFile << "(" << std::get<1>(bestPath) << ")\n";
+                bestPath.render(outputFile, *g, ",", 0, parking);
+                outputFile << "(" << bestPath.getTime() << ")\n";
 
                 // Parking Node
-                outputFile << "ParkingNode" << i + 1 << ":" << std::get<2>(bestPath) << "\n";
+                outputFile << "ParkingNode" << i + 1 << ":" << bestPath.getVertex(*g, parking)->getLocationSymbol() << "\n";
 
                 // Walking Route
                 outputFile << "WalkingRoute" << i + 1 << ":";
-                bool walkingPhase = false;
-                for (const auto& node : std::get<0>(bestPath)) {
-                    if (node == std::get<2>(bestPath)) walkingPhase = true;
-                    if (walkingPhase) {
-                        outputFile << node << ",";
-                    }
-                }
-                outputFile.seekp(-1, std::ios_base::cur);
-                outputFile << "(" << walking_times[i] << ")\n";
+                bestPath.render(outputFile, *g, ",", parking, bestPath.size());
+                outputFile << "(" << bestPath.getLegTime(1) << ")\n";
 
-                outputFile << "TotalTime" << i + 1 << ":" << std::get<1>(bestPath) << "\n";
+                outputFile << "TotalTime" << i + 1 << ":" << bestPath.getTime() << "\n";
             }
 
             std::cout << "Successfully written result to output.txt" << std::endl;
@@ -1228,28 +1535,22 @@ void Menu<T>::printAlternativeEnvFriendlyRoutes(Vertex<T>* source, Vertex<T>* ta
 
         else {
             for (int i = 0; i < 2; ++i) {
-                auto bestPath = alternativePaths[i];
+                const Path<T>& bestPath = alternativePaths[i];
+                size_t parking = bestPath.getLegStart(1);
                 std::cout << "Alternative "<< i+1 << ":" << std::endl;
                 std::cout << "Source:" << origin << "\n";
                 std::cout << "Destination:" << destination << "\n";
                 std::cout << "DrivingRoute" << i + 1 << ":";
-                for (const auto& node : std::get<0>(bestPath)) {
-                    if (node != std::get<2>(bestPath)) std::cout << node << ",";
-                    else break;
-                }
-                std::cout << "(" << std::get<1>(bestPath) << ")\n";
+                bestPath.render(std::cout, *g, ",", 0, parking);
+                std::cout << ",(" << bestPath.getTime() << ")\n";
 
-                std::cout << "ParkingNode" << i + 1 << ":" << std::get<2>(bestPath) << "\n";
+                std::cout << "ParkingNode" << i + 1 << ":" << bestPath.getVertex(*g, parking)->getLocationSymbol() << "\n";
 
                 std::cout << "WalkingRoute" << i + 1 << ":";
-                bool walkingPhase = false;
-                for (const auto& node : std::get<0>(bestPath)) {
-                    if (node == std::get<2>(bestPath)) walkingPhase = true;
-                    if (walkingPhase) std::cout << node << ",";
-                }
-                std::cout << "(" << walking_times[i] << ")\n";
+                bestPath.render(std::cout, *g, ",", parking, bestPath.size());
+                std::cout << ",(" << bestPath.getLegTime(1) << ")\n";
 
-                std::cout << "TotalTime" << i + 1 << ":" << std::get<1>(bestPath) << "\n";
+                std::cout << "TotalTime" << i + 1 << ":" << bestPath.getTime() << "\n";
             }
         }
 
@@ -1268,6 +1569,7 @@ void Menu<T>::printInitialMenu() {
     std::cout << "3. Find the fastest environmentally friendly route\n";
     std::cout << "4. Find the alternatives for environmentally friendly route\n";
     std::cout << "5. Exit\n";
+    std::cout << "6. Find alternative driving or walking routes\n";
 
     while (!exit) {
 
@@ -1296,6 +1598,10 @@ void Menu<T>::printInitialMenu() {
                 std::cout << "Exiting...\n";
                 exit = true;
             break;
+            case 6:
+                this->alternativeRoutes();
+                exit = true;
+                break;
             default:
                 std::cout << "Invalid option. Please try again.\n";
             break;
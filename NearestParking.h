@@ -0,0 +1,116 @@
+/**
+ * @file NearestParking.h
+ * @brief The nearest parking place of every vertex, from one multi-source Dijkstra search.
+ *
+ * Finding the closest parking place of one vertex takes a search; finding it for every vertex takes a single
+ * search started from all parking places at once, where each vertex is settled by the parking place it is
+ * closest to. The table answers coverage questions in constant time and gives env-friendly planners a lower
+ * bound on the walking leg of any route ending at a vertex.
+ */
+
+#ifndef NEAREST_PARKING_H
+#define NEAREST_PARKING_H
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "./data_structures/Graph.h"
+
+/**
+ * @class NearestParking
+ * @brief For every vertex, the parking place with the shortest path to it in one travel mode, and the time
+ * of that path.
+ *
+ * Times run from the parking place to the vertex, as the walking leg of an env-friendly route does; on
+ * two-way segments they are also the times from the vertex to the parking place. Avoiding vertices or edges
+ * can only make paths longer, so the times are lower bounds for restricted queries too.
+ * The table reflects the graph when build() was called and must be rebuilt after it changes.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class NearestParking {
+public:
+    /**
+     * @brief Fills the table with a Dijkstra search started from every parking place at distance 0.
+     *
+     * @param g The graph.
+     * @param weight Weight policy (see dijkstra.h) of the travel mode, such as WalkingTime.
+     *
+     * @complexity O((V + E) \log V)
+     */
+    template <class WeightPolicy>
+    void build(const Graph<T> &g, const WeightPolicy &weight);
+
+    bool isBuilt() const { return graph != nullptr; }
+
+    /**
+     * @brief Returns the nearest parking place of a vertex (the vertex itself if it has parking), or nullptr
+     * if no parking place reaches it.
+     */
+    Vertex<T> *getParking(const Vertex<T> *v) const {
+        int p = nearest[v->getIndex()];
+        return p < 0 ? nullptr : graph->getVertexSet()[p];
+    }
+
+    /**
+     * @brief Returns the time from the nearest parking place to a vertex, or UNREACHABLE.
+     */
+    Distance getTime(const Vertex<T> *v) const { return time[v->getIndex()]; }
+
+    /**
+     * @brief Returns the vertices with no parking place within a time, in vertex order.
+     *
+     * @complexity O(V)
+     */
+    std::vector<Vertex<T> *> getUncovered(Distance radius) const {
+        std::vector<Vertex<T> *> uncovered;
+        for (Vertex<T> *v : graph->getVertexSet()) {
+            if (time[v->getIndex()] > radius) uncovered.push_back(v);
+        }
+        return uncovered;
+    }
+
+private:
+    const Graph<T> *graph = nullptr;
+    std::vector<Distance> time; // by vertex position
+    std::vector<int> nearest;   // position of the nearest parking place, -1 if none
+};
+
+template <class T>
+template <class WeightPolicy>
+void NearestParking<T>::build(const Graph<T> &g, const WeightPolicy &weight) {
+    typedef std::pair<Distance, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> q;
+    const std::vector<Vertex<T> *> &vertices = g.getVertexSet();
+
+    graph = &g;
+    time.assign(vertices.size(), UNREACHABLE);
+    nearest.assign(vertices.size(), -1);
+    for (const Vertex<T> *v : vertices) {
+        if (!v->getParking()) continue;
+        time[v->getIndex()] = 0;
+        nearest[v->getIndex()] = v->getIndex();
+        q.push(std::make_pair(Distance(0), v->getIndex()));
+    }
+
+    while (!q.empty()) {
+        Entry top = q.top();
+        q.pop();
+        int v = top.second;
+        if (top.first > time[v]) continue; // Outdated entry
+        for (const Edge<T> *e : weight.adjacency(vertices[v])) {
+            int u = e->getDest()->getIndex();
+            Distance d = saturatingAdd(top.first, weight(e));
+            if (d < time[u]) {
+                time[u] = d;
+                nearest[u] = nearest[v];
+                q.push(std::make_pair(d, u));
+            }
+        }
+    }
+}
+
+#endif //NEAREST_PARKING_H
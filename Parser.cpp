@@ -2,21 +2,85 @@
 // Created by carolina on 17/03/25.
 //
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <string>
 #include <iostream>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "Parser.h"
+#include "./data_structures/GraphBuilder.h"
+#include "MappedFile.h"
+#include "CsvReader.h"
 
 /**
  * @file Parser.cpp
  * @brief Implementation file for the Parser class.
  *
  * This file contains the implementation of the Parser class methods for parsing location and distance data from CSV files.
+ * The files are memory-mapped and tokenized in place by CsvReader, so fields are never copied unless they are stored.
  */
 
+const size_t Parser::MIN_CHUNK_BYTES;
+
+namespace {
+
+/*
+ * Open-addressing table from location code to vertex, looked up with fields that point into the mapped file.
+ * The keys point into Graph::names, to which no string may be added while the table is in use.
+ */
+class CodeIndex {
+public:
+    explicit CodeIndex(const Graph<int> &graph) {
+        std::unordered_map<int, Vertex<int> *> byId;
+        for (Vertex<int> *v : graph.getVertexSet()) byId[v->getInfo()] = v;
+
+        size_t capacity = 16;
+        while (capacity < graph.codeToId.size() * 2) capacity *= 2;
+        slots.resize(capacity);
+        mask = capacity - 1;
+
+        for (const auto &entry : graph.codeToId) {
+            auto it = byId.find(entry.second);
+            if (it == byId.end()) continue;
+            size_t i = hash(entry.first.c_str(), entry.first.size()) & mask;
+            while (slots[i].vertex != nullptr) i = (i + 1) & mask;
+            slots[i] = Slot{entry.first.c_str(), entry.first.size(), it->second};
+        }
+    }
+
+    Vertex<int> *find(const CsvField &code) const {
+        size_t i = hash(code.begin, code.size()) & mask;
+        while (slots[i].vertex != nullptr) {
+            if (slots[i].length == code.size() && std::memcmp(slots[i].key, code.begin, code.size()) == 0) {
+                return slots[i].vertex;
+            }
+            i = (i + 1) & mask;
+        }
+        return nullptr;
+    }
+
+private:
+    struct Slot {
+        const char *key = nullptr;
+        size_t length = 0;
+        Vertex<int> *vertex = nullptr;
+    };
+    std::vector<Slot> slots;
+    size_t mask = 0;
+
+    static size_t hash(const char *p, size_t n) { // FNV-1a
+        size_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < n; i++) {
+            h ^= static_cast<unsigned char>(p[i]);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+}
 
 /**
  * @brief Parses location data from a CSV file and adds vertices to the graph.
@@ -26,50 +90,128 @@
  */
 void Parser::parseLocations(const string &filename, Graph<int> &graph) {
     cout << "Parsing locations from " << filename << endl;
-    ifstream file(filename);
-    string line;
-    cout << line << endl;
-    getline(file, line); // Skip header
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string location, code;
+    MappedFile file;
+    if (!file.open(filename)) {
+        cerr << "Error: Could not open " << filename << endl;
+        return;
+    }
+
+    CsvReader reader(file.data(), file.data() + file.size());
+    reader.skipRow(); // Skip header
+    GraphBuilder<int> builder;
+    CsvField fields[4];
+    int count;
+    while ((count = reader.readRow(fields, 4)) > 0) {
         int id, parking;
-        getline(ss, location, ',');
-        ss >> id;
-        ss.ignore();
-        getline(ss, code, ',');
-        ss >> parking;
-        graph.addVertex(id, location, code, parking);
-        graph.codeToId[code] = id;
+        if (count < 4 || !parseCsvInt(fields[1], id) || !parseCsvInt(fields[3], parking)) {
+            cerr << filename << ":" << reader.getLine() << ": malformed location, skipped" << endl;
+            continue;
+        }
+        builder.addVertex(id, fields[0].str(), fields[2].str(), parking);
+    }
+
+    if (!builder.build(graph)) {
+        for (const string &error : builder.getErrors()) cerr << filename << ": " << error << ", skipped" << endl;
     }
 }
 
+namespace {
+
+/*
+ * Segments and errors found in one line-aligned chunk of Distances.csv.
+ */
+struct DistanceChunk {
+    const char *begin;
+    const char *end;
+    std::vector<SegmentInput<int>> segments;
+    std::vector<std::pair<int, const char *>> errors; // line within the chunk, message
+    int lines = 0;
+
+    DistanceChunk(const char *begin, const char *end) : begin(begin), end(end) {}
+};
+
+void parseDistanceChunk(DistanceChunk &chunk, const CodeIndex &index, bool skipHeader) {
+    CsvReader reader(chunk.begin, chunk.end);
+    if (skipHeader) reader.skipRow();
+    CsvField fields[4];
+    int count;
+    while ((count = reader.readRow(fields, 4)) > 0) {
+        int drivingTime = IMPASSABLE, walkingTime;
+        bool valid = count >= 4 && parseCsvInt(fields[3], walkingTime) && isValidWeight(walkingTime);
+        if (valid && !(fields[2] == "X")) valid = parseCsvInt(fields[2], drivingTime) && isValidWeight(drivingTime);
+        if (!valid) {
+            chunk.errors.emplace_back(reader.getLine(), "malformed segment, skipped");
+            continue;
+        }
+
+        Vertex<int> *orig = index.find(fields[0]);
+        Vertex<int> *dest = index.find(fields[1]);
+        if (!orig || !dest) {
+            chunk.errors.emplace_back(reader.getLine(), "unknown location in segment, skipped");
+            continue;
+        }
+        chunk.segments.push_back(SegmentInput<int>{orig, dest, static_cast<Weight>(drivingTime),
+                                                   static_cast<Weight>(walkingTime)});
+    }
+    chunk.lines = reader.getLine();
+}
+
+}
+
 /**
 * @brief Parses distance data from a CSV file and adds edges to the graph.
 *
+* Driving times given as "X" mark segments that can only be walked; they are stored with a driving time of IMPASSABLE.
+* Times that do not fit in a Weight are reported as malformed.
+* The file is split into line-aligned chunks that are parsed on worker threads; the segments are then added to the
+* graph in a single Graph::addEdges call, in file order.
+*
 * @param filename The name of the CSV file containing distance data.
 * @param graph The graph object to which the edges will be added.
+* @param numThreads The maximum number of worker threads, or 0 to use one per hardware thread.
+* @param minChunkBytes The smallest chunk given to a thread, so small files are parsed on the calling thread alone.
 */
-void Parser::parseDistances(const string &filename, Graph<int> &graph) {
-    ifstream file(filename);
-    string line;
-    getline(file, line);
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string loc1, loc2, driving, walking;
-        getline(ss, loc1, ',');
-        getline(ss, loc2, ',');
-        getline(ss, driving, ',');
-        getline(ss, walking, ',');
-
-        int origInt = graph.codeToId[loc1];
-        int destInt = graph.codeToId[loc2];
-
-        Vertex<int> * orig = graph.findVertex(origInt);
-		Vertex<int> * dest = graph.findVertex(destInt);
-
-        int drivingTime = (driving == "X") ? 500000 : stoi(driving);
-        int walkingTime = stoi(walking);
-        graph.addEdge(orig, dest, drivingTime, walkingTime);
+void Parser::parseDistances(const string &filename, Graph<int> &graph, unsigned numThreads, size_t minChunkBytes) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        cerr << "Error: Could not open " << filename << endl;
+        return;
     }
-}
\ No newline at end of file
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+
+    if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t numChunks = std::min<size_t>(numThreads, std::max<size_t>(1, file.size() / std::max<size_t>(1, minChunkBytes)));
+
+    std::vector<DistanceChunk> chunks;
+    const char *p = begin;
+    for (size_t i = 0; i < numChunks && p < end; i++) {
+        const char *chunkEnd = (i + 1 == numChunks) ? end : begin + file.size() * (i + 1) / numChunks;
+        if (chunkEnd < p) chunkEnd = p;
+        chunkEnd = findLineEnd(chunkEnd, end);
+        if (chunkEnd < end) chunkEnd++;
+        chunks.emplace_back(p, chunkEnd);
+        p = chunkEnd;
+    }
+
+    CodeIndex index(graph);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks.size(); i++) {
+        workers.emplace_back(parseDistanceChunk, std::ref(chunks[i]), std::cref(index), false);
+    }
+    if (!chunks.empty()) parseDistanceChunk(chunks[0], index, true); // Skip header
+    for (std::thread &worker : workers) worker.join();
+
+    std::vector<SegmentInput<int>> segments;
+    int firstLine = 0;
+    for (DistanceChunk &chunk : chunks) {
+        for (const auto &error : chunk.errors) {
+            cerr << filename << ":" << firstLine + error.first << ": " << error.second << endl;
+        }
+        firstLine += chunk.lines;
+        segments.insert(segments.end(), chunk.segments.begin(), chunk.segments.end());
+        std::vector<SegmentInput<int>>().swap(chunk.segments);
+    }
+
+    graph.addEdges(segments);
+}
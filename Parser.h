@@ -12,8 +12,12 @@ using namespace std;
 
 class Parser {
     public:
+        /// Smallest chunk of Distances.csv given to a thread; below this, starting a thread costs more than it saves.
+        static const size_t MIN_CHUNK_BYTES = 1 << 20;
+
         static void parseLocations(const std::string &filename, Graph<int> &graph);
-        static void parseDistances(const std::string &filename, Graph<int> &graph);
+        static void parseDistances(const std::string &filename, Graph<int> &graph, unsigned numThreads = 0,
+                                   size_t minChunkBytes = MIN_CHUNK_BYTES);
 
 };
 
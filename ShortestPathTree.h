@@ -0,0 +1,236 @@
+/**
+ * @file ShortestPathTree.h
+ * @brief Header file for a shortest-path tree that can be repaired after small graph changes.
+ *
+ * Instead of running Dijkstra's algorithm from scratch after a few edges change, the tree is updated in the
+ * style of Ramalingam and Reps: only the vertices whose shortest path used an edge that got longer (or was
+ * removed) are invalidated, and a Dijkstra search restricted to the vertices whose distance actually changes
+ * repairs the tree.
+ */
+
+#ifndef SHORTEST_PATH_TREE_H
+#define SHORTEST_PATH_TREE_H
+
+#include <algorithm>
+#include <queue>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "./data_structures/Graph.h"
+#include "./data_structures/WeightVersions.h"
+
+/**
+ * @class ShortestPathTree
+ * @brief Shortest distances and parent edges from one fixed source, for one metric.
+ *
+ * The metric is a weight policy (see dijkstra.h), such as DrivingTime, or SnapshotTime to read a version of
+ * the weights. Typical subscribers are routes tracked from depots: build the tree once, and after every batch
+ * published through VersionedWeights call refresh() with that batch and a policy reading the new version.
+ * Every call must use the same metric.
+ *
+ * The tree keeps its own distance and parent arrays, indexed by Vertex::getIndex(), so it does not interfere
+ * with the state dijkstra() leaves on the vertices.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class ShortestPathTree {
+public:
+    /**
+     * @brief Creates an empty tree. Call build() before querying it.
+     * @param g Pointer to the graph object.
+     * @param source The vertex the tree is rooted at.
+     */
+    ShortestPathTree(const Graph<T> *g, Vertex<T> *source) : g(g), source(source) {}
+
+    /**
+     * @brief Computes the tree from scratch.
+     *
+     * @param weight The weight policy.
+     *
+     * @complexity O((V + E) \log V)
+     */
+    template <class WeightPolicy>
+    void build(const WeightPolicy &weight) {
+        dist.assign(g->getNumVertex(), UNREACHABLE);
+        parent.assign(g->getNumVertex(), nullptr);
+        dist[source->getIndex()] = 0;
+        q.push(std::make_pair(Distance(0), source));
+        propagate(weight, {});
+    }
+
+    /**
+     * @brief Repairs the tree after edges were inserted, removed or changed weight.
+     *
+     * Edges that were removed must be passed here before they are deleted from the graph.
+     *
+     * @param weight The weight policy, giving the weights after the change.
+     * @param changed Edges whose weight changed, including newly inserted edges.
+     * @param removed Edges that are about to be removed from the graph.
+     *
+     * @complexity O((A + C) \log A), where C is the number of changed edges and A the number of vertices
+     * (and their edges) whose distance or parent changes.
+     */
+    template <class WeightPolicy>
+    void update(const WeightPolicy &weight, const std::vector<Edge<T> *> &changed,
+                const std::vector<Edge<T> *> &removed = {}) {
+        if ((int) dist.size() < g->getNumVertex()) {
+            dist.resize(g->getNumVertex(), UNREACHABLE);
+            parent.resize(g->getNumVertex(), nullptr);
+        }
+        std::unordered_set<const Edge<T> *> gone(removed.begin(), removed.end());
+
+        // Vertices below an edge of the tree that got longer or disappeared lose their distance
+        std::vector<Vertex<T> *> affected;
+        for (const std::vector<Edge<T> *> *edges : {&changed, &removed}) {
+            for (Edge<T> *e : *edges) {
+                Vertex<T> *u = e->getOrig();
+                Vertex<T> *v = e->getDest();
+                if (parent[v->getIndex()] != e) continue;
+                if (gone.count(e) || weight(e) > dist[v->getIndex()] - dist[u->getIndex()]) {
+                    collectSubtree(v, affected);
+                }
+            }
+        }
+        for (Vertex<T> *v : affected) {
+            dist[v->getIndex()] = UNREACHABLE;
+            parent[v->getIndex()] = nullptr;
+        }
+
+        // Their best entry from the part of the tree that is still valid
+        for (Vertex<T> *v : affected) {
+            for (Edge<T> *e : v->getIncoming()) {
+                if (gone.count(e)) continue;
+                Distance d = saturatingAdd(dist[e->getOrig()->getIndex()], weight(e));
+                if (d < dist[v->getIndex()]) {
+                    dist[v->getIndex()] = d;
+                    parent[v->getIndex()] = e;
+                }
+            }
+            if (dist[v->getIndex()] != UNREACHABLE) q.push(std::make_pair(dist[v->getIndex()], v));
+        }
+
+        // Edges that got shorter or were inserted may improve their head
+        for (Edge<T> *e : changed) {
+            if (gone.count(e)) continue;
+            Distance d = saturatingAdd(dist[e->getOrig()->getIndex()], weight(e));
+            Vertex<T> *v = e->getDest();
+            if (d < dist[v->getIndex()]) {
+                dist[v->getIndex()] = d;
+                parent[v->getIndex()] = e;
+                q.push(std::make_pair(dist[v->getIndex()], v));
+            }
+        }
+
+        propagate(weight, gone);
+    }
+
+    /**
+     * @brief Repairs the tree after a batch was applied through VersionedWeights::apply.
+     *
+     * @param weight The weight policy reading the version published for the batch.
+     * @param batch The batch that was applied.
+     */
+    template <class WeightPolicy>
+    void refresh(const WeightPolicy &weight, const std::vector<WeightUpdate<T>> &batch) {
+        std::vector<Edge<T> *> changed;
+        for (const WeightUpdate<T> &u : batch) {
+            if (u.edge == nullptr) continue;
+            changed.push_back(u.edge);
+            if (u.bothDirections && u.edge->getReverse() != nullptr) changed.push_back(u.edge->getReverse());
+        }
+        update(weight, changed);
+    }
+
+    /**
+     * @brief Returns the shortest distance from the source, or UNREACHABLE if the vertex cannot be reached.
+     */
+    Distance getDist(const Vertex<T> *v) const {
+        return v->getIndex() < (int) dist.size() ? dist[v->getIndex()] : UNREACHABLE;
+    }
+
+    /**
+     * @brief Returns the last edge of the shortest path to a vertex, or nullptr for the source and unreached vertices.
+     */
+    Edge<T> *getParent(const Vertex<T> *v) const {
+        return v->getIndex() < (int) parent.size() ? parent[v->getIndex()] : nullptr;
+    }
+
+    Vertex<T> *getSource() const { return source; }
+
+    /**
+     * @brief Retrieves the path from the source to a vertex, as the interned location names of its vertices
+     * and its time, with a time of -1 if the vertex cannot be reached.
+     *
+     * @complexity O(L), where L is the number of vertices in the path.
+     */
+    std::pair<std::vector<Symbol>, int> getPath(const Vertex<T> *target) const {
+        std::vector<Symbol> path;
+        const Vertex<T> *v = target;
+        while (v != nullptr) {
+            path.push_back(v->getLocationSymbol());
+            Edge<T> *e = getParent(v);
+            v = e ? e->getOrig() : nullptr;
+        }
+        std::reverse(path.begin(), path.end());
+        Distance d = getDist(target);
+        return std::make_pair(path, d == UNREACHABLE ? -1 : static_cast<int>(d));
+    }
+
+private:
+    typedef std::pair<Distance, Vertex<T> *> Entry;
+
+    struct Later {
+        bool operator()(const Entry &a, const Entry &b) const { return a.first > b.first; }
+    };
+
+    const Graph<T> *g;
+    Vertex<T> *source;
+
+    std::vector<Distance> dist;
+    std::vector<Edge<T> *> parent;
+    std::priority_queue<Entry, std::vector<Entry>, Later> q;
+
+    /*
+     * Adds v and every vertex whose tree path goes through v to out, detaching them from the tree
+     * so that overlapping subtrees are only collected once.
+     */
+    void collectSubtree(Vertex<T> *v, std::vector<Vertex<T> *> &out) {
+        size_t first = out.size();
+        out.push_back(v);
+        for (size_t i = first; i < out.size(); i++) {
+            for (Edge<T> *e : out[i]->getAdj()) {
+                if (parent[e->getDest()->getIndex()] == e) out.push_back(e->getDest());
+            }
+        }
+        for (size_t i = first; i < out.size(); i++) parent[out[i]->getIndex()] = nullptr;
+    }
+
+    /*
+     * Runs Dijkstra's algorithm from the entries already in the queue, skipping outdated ones.
+     */
+    template <class WeightPolicy>
+    void propagate(const WeightPolicy &weight, const std::unordered_set<const Edge<T> *> &gone) {
+        while (!q.empty()) {
+            Entry top = q.top();
+            q.pop();
+            Vertex<T> *v = top.second;
+            if (top.first > dist[v->getIndex()]) continue;
+
+            for (Edge<T> *e : weight.adjacency(v)) {
+                if (gone.count(e)) continue;
+                Vertex<T> *u = e->getDest();
+                Distance d = saturatingAdd(top.first, weight(e));
+                if (d < dist[u->getIndex()]) {
+                    dist[u->getIndex()] = d;
+                    parent[u->getIndex()] = e;
+                    q.push(std::make_pair(d, u));
+                }
+            }
+        }
+    }
+};
+
+#endif //SHORTEST_PATH_TREE_H
@@ -0,0 +1,68 @@
+/**
+ * @file SnapshotConverter.cpp
+ * @brief Command-line tool that converts Locations.csv and Distances.csv into a binary graph snapshot.
+ *
+ * Usage:
+ *   1stDA_Snapshot [--order rcm|bfs|csv] <Locations.csv> <Distances.csv> <output.snap>
+ *   1stDA_Snapshot --info <file.snap>
+ *
+ * The main program loads ../data/graph.snap instead of the CSV files when it exists and the CSV files still
+ * have the size and modification time recorded in it; after they change it parses them again until the
+ * snapshot is regenerated.
+ *
+ * Vertices are renumbered before writing so that neighbouring locations are stored close together: by
+ * reverse Cuthill-McKee (the default), breadth-first, or left in the order of Locations.csv.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "GraphSnapshot.h"
+#include "Parser.h"
+#include "VertexOrdering.h"
+
+int main(int argc, char *argv[]) {
+    if (argc == 3 && std::string(argv[1]) == "--info") {
+        GraphSnapshot snapshot;
+        if (!snapshot.open(argv[2])) {
+            std::cerr << "Error: " << argv[2] << " is not a valid graph snapshot (format version "
+                      << GraphSnapshot::FORMAT_VERSION << ")\n";
+            return 1;
+        }
+        std::cout << "Format version: " << GraphSnapshot::FORMAT_VERSION << "\n"
+                  << "Vertices: " << snapshot.getNumVertex() << "\n"
+                  << "Edges: " << snapshot.getNumEdges() << "\n";
+        return 0;
+    }
+
+    std::string order = "rcm";
+    int first = 1;
+    if (argc == 6 && std::string(argv[1]) == "--order") {
+        order = argv[2];
+        first = 3;
+    }
+    if (argc != first + 3 || (order != "rcm" && order != "bfs" && order != "csv")) {
+        std::cerr << "Usage: " << argv[0] << " [--order rcm|bfs|csv] <Locations.csv> <Distances.csv> <output.snap>\n"
+                  << "       " << argv[0] << " --info <file.snap>\n";
+        return 1;
+    }
+
+    Graph<int> graph;
+    Parser::parseLocations(argv[first], graph);
+    Parser::parseDistances(argv[first + 1], graph);
+
+    if (order != "csv") {
+        int before = bandwidth(graph);
+        graph.renumber(order == "rcm" ? reverseCuthillMcKeeOrder(graph) : breadthFirstOrder(graph));
+        std::cout << "Renumbered vertices (" << order << "), bandwidth " << before << " -> " << bandwidth(graph) << "\n";
+    }
+
+    const char *output = argv[first + 2];
+    if (!GraphSnapshot::write(graph, output, argv[first], argv[first + 1])) {
+        std::cerr << "Error: Could not write " << output << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << graph.getNumVertex() << " vertices and " << graph.getNumEdges()
+              << " edges to " << output << "\n";
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file VertexOrdering.h
+ * @brief Vertex orders that place neighbouring vertices close together, for Graph::renumber.
+ *
+ * Vertices are numbered in the order of Locations.csv, so the neighbours of a vertex usually sit far apart in
+ * the vertex set and in every array indexed by vertex (search workspaces, shortest-path trees, snapshots).
+ * Renumbering the graph with one of these orders keeps the vertices a search expands together close in
+ * memory, so a search touches fewer cache lines.
+ */
+
+#ifndef VERTEX_ORDERING_H
+#define VERTEX_ORDERING_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+#include <vector>
+
+#include "./data_structures/Graph.h"
+
+/*
+ * Appends the vertices reached from start that are not placed yet to order, in breadth-first order.
+ * With byDegree, the new neighbours of each vertex are taken from lowest to highest degree.
+ */
+template <class T>
+void appendBreadthFirst(const Graph<T> &g, int start, bool byDegree, std::vector<bool> &placed, std::vector<int> &order) {
+    std::vector<int> neighbours;
+    size_t next = order.size();
+    placed[start] = true;
+    order.push_back(start);
+
+    while (next < order.size()) {
+        const Vertex<T> *v = g.getVertexSet()[order[next++]];
+        neighbours.clear();
+        for (const Edge<T> *e : v->getAdj()) {
+            int u = e->getDest()->getIndex();
+            if (!placed[u]) {
+                placed[u] = true;
+                neighbours.push_back(u);
+            }
+        }
+        if (byDegree) {
+            std::stable_sort(neighbours.begin(), neighbours.end(), [&g](int a, int b) {
+                return g.getVertexSet()[a]->getAdj().size() < g.getVertexSet()[b]->getAdj().size();
+            });
+        }
+        order.insert(order.end(), neighbours.begin(), neighbours.end());
+    }
+}
+
+/**
+ * @brief Orders the vertices breadth-first, one connected component after the other.
+ *
+ * Each component starts at its vertex that comes first in the current order.
+ *
+ * @tparam T The type of the vertex information.
+ * @param g The graph.
+ * @return The current positions of the vertices in their new order, as taken by Graph::renumber.
+ *
+ * @complexity O(V + E)
+ */
+template <class T>
+std::vector<int> breadthFirstOrder(const Graph<T> &g) {
+    std::vector<bool> placed(g.getNumVertex(), false);
+    std::vector<int> order;
+    order.reserve(g.getNumVertex());
+    for (int v = 0; v < g.getNumVertex(); v++) {
+        if (!placed[v]) appendBreadthFirst(g, v, false, placed, order);
+    }
+    return order;
+}
+
+/**
+ * @brief Orders the vertices with the reverse Cuthill-McKee algorithm.
+ *
+ * Each component is traversed breadth-first from a vertex of lowest degree, visiting new neighbours from
+ * lowest to highest degree, and the complete order is reversed. This keeps the index distance between the
+ * ends of each edge small.
+ *
+ * @tparam T The type of the vertex information.
+ * @param g The graph.
+ * @return The current positions of the vertices in their new order, as taken by Graph::renumber.
+ *
+ * @complexity O(V \log V + E \log D), where D is the largest degree.
+ */
+template <class T>
+std::vector<int> reverseCuthillMcKeeOrder(const Graph<T> &g) {
+    std::vector<int> byDegree(g.getNumVertex());
+    for (int v = 0; v < g.getNumVertex(); v++) byDegree[v] = v;
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&g](int a, int b) {
+        return g.getVertexSet()[a]->getAdj().size() < g.getVertexSet()[b]->getAdj().size();
+    });
+
+    std::vector<bool> placed(g.getNumVertex(), false);
+    std::vector<int> order;
+    order.reserve(g.getNumVertex());
+    for (int v : byDegree) {
+        if (!placed[v]) appendBreadthFirst(g, v, true, placed, order);
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/**
+ * @brief Returns the bandwidth of the graph: the largest difference between the positions of the two ends
+ * of an edge. Smaller is better for locality.
+ *
+ * @complexity O(V + E)
+ */
+template <class T>
+int bandwidth(const Graph<T> &g) {
+    int width = 0;
+    for (const Vertex<T> *v : g.getVertexSet()) {
+        for (const Edge<T> *e : v->getAdj()) {
+            width = std::max(width, std::abs(e->getDest()->getIndex() - v->getIndex()));
+        }
+    }
+    return width;
+}
+
+#endif //VERTEX_ORDERING_H
@@ -0,0 +1,99 @@
+/**
+ * @file ViaRouting.h
+ * @brief Fastest routes through a chosen vertex, from one forward and one reverse search.
+ *
+ * The fastest route from s to t through v is the fastest route from s to v followed by the fastest route from
+ * v to t. A forward search from s and a reverse search from t give both halves for every v at once, so once
+ * they have run, each via vertex costs two lookups instead of two searches, and many of them can be compared.
+ */
+
+#ifndef VIA_ROUTING_H
+#define VIA_ROUTING_H
+
+#include <utility>
+#include <vector>
+
+#include "dijkstra.h"
+#include "./data_structures/TopK.h"
+
+/**
+ * @class ViaRouter
+ * @brief The search trees of one source, target and set of things to avoid, answering via queries.
+ *
+ * The answers reflect the graph and the restrictions given to build() and must be rebuilt after they change.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class ViaRouter {
+public:
+    /**
+     * @brief Runs the forward search from the source and the reverse search from the target.
+     *
+     * @param weight Weight policy (see dijkstra.h) of the travel mode, such as DrivingTime.
+     *
+     * @complexity O((V + E) \log V + N + S), as two runs of dijkstra().
+     */
+    template <class WeightPolicy>
+    void build(const Graph<T> *g, const Vertex<T> *source, const Vertex<T> *target,
+               const std::vector<Vertex<T> *> &nodesToAvoid, const std::vector<Edge<T> *> &segmentsToAvoid,
+               const WeightPolicy &weight) {
+        this->source = source;
+        this->target = target;
+        dijkstra(g, source, nodesToAvoid, segmentsToAvoid, weight, forward);
+        reverseDijkstra(g, target, nodesToAvoid, segmentsToAvoid, weight, backward);
+    }
+
+    /**
+     * @brief Returns the time of the fastest route through a vertex, or UNREACHABLE if there is none.
+     *
+     * @complexity O(1)
+     */
+    Distance getTime(const Vertex<T> *via) const {
+        return saturatingAdd(forward.getDist(via), backward.getDist(via));
+    }
+
+    /**
+     * @brief Returns the fastest route through a vertex as two legs, source to via and via to target, or an
+     * empty path if there is none.
+     *
+     * @complexity O(L), where L is the number of vertices in the route.
+     */
+    Path<T> getRoute(const Vertex<T> *via) const {
+        if (getTime(via) == UNREACHABLE) return Path<T>();
+        Path<T> route = extractPath(forward, source, via);
+        route.append(extractReversePath(backward, via, target));
+        return route;
+    }
+
+    /**
+     * @brief Ranks candidate via vertices by the time of the fastest route through them.
+     *
+     * @return Up to k of the candidates a route passes through, fastest first; ties keep the order given.
+     *
+     * @complexity O(C log k), for C candidates.
+     */
+    std::vector<Vertex<T> *> rank(const std::vector<Vertex<T> *> &candidates, size_t k) const {
+        typedef std::pair<Distance, Vertex<T> *> Entry;
+        BoundedHeap<Entry, bool (*)(const Entry &, const Entry &)> best(k, &ViaRouter::faster);
+        for (Vertex<T> *v : candidates) {
+            Distance time = getTime(v);
+            if (time != UNREACHABLE) best.offer(std::make_pair(time, v));
+        }
+        std::vector<Vertex<T> *> ranked;
+        for (const Entry &e : best.take()) ranked.push_back(e.second);
+        return ranked;
+    }
+
+private:
+    const Vertex<T> *source = nullptr;
+    const Vertex<T> *target = nullptr;
+    SearchWorkspace<T> forward;  // from the source
+    SearchWorkspace<T> backward; // to the target
+
+    static bool faster(const std::pair<Distance, Vertex<T> *> &a, const std::pair<Distance, Vertex<T> *> &b) {
+        return a.first < b.first;
+    }
+};
+
+#endif //VIA_ROUTING_H
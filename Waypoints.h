@@ -0,0 +1,79 @@
+/**
+ * @file Waypoints.h
+ * @brief Fastest routes that visit an ordered list of stops, one leg per pair of consecutive stops.
+ *
+ * With the stops fixed, the fastest route is the fastest leg between each pair of consecutive stops, and the
+ * legs do not depend on each other. Each leg is a search that ends as soon as it reaches the next stop, and
+ * the legs are spread over worker threads, each with its own workspace.
+ */
+
+#ifndef WAYPOINTS_H
+#define WAYPOINTS_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "dijkstra.h"
+
+/*
+ * Searches the legs taken from next, in order, until none is left, keeping each path in legs.
+ */
+template <class T, class WeightPolicy>
+void searchLegs(const Graph<T> *g, const std::vector<Vertex<T> *> &stops, const std::vector<Vertex<T> *> &nodesToAvoid,
+                const std::vector<Edge<T> *> &segmentsToAvoid, const WeightPolicy &weight, SearchWorkspace<T> &search,
+                std::atomic<size_t> &next, std::vector<Path<T>> &legs) {
+    for (size_t leg = next++; leg < legs.size(); leg = next++) {
+        const Vertex<T> *from = stops[leg], *to = stops[leg + 1];
+        dijkstra(g, from, nodesToAvoid, segmentsToAvoid, weight, search, UNREACHABLE,
+                 [to](const Vertex<T> *v, Distance) { return v != to; });
+        legs[leg] = extractPath(search, from, to);
+    }
+}
+
+/**
+ * @brief Finds the fastest route from the first stop to the last that visits the others in order.
+ *
+ * Every leg avoids the same vertices and edges. The legs are searched by up to numThreads threads (one per
+ * hardware thread if 0), the calling thread included, and the workspaces list grows to one per thread.
+ *
+ * @tparam WeightPolicy The weight policy, such as DrivingTime.
+ * @param stops The source, the stops in the order to visit them, and the target.
+ * @param searches Workspaces for the threads; must not be used by anything else while this runs.
+ * @return The route with one leg per pair of consecutive stops, or an empty path if a leg has no route.
+ *
+ * @complexity O(L (R + A) \log R / P), for L legs whose searches reach R vertices and A edges, on P threads.
+ */
+template <class T, class WeightPolicy>
+Path<T> routeThroughStops(const Graph<T> *g, const std::vector<Vertex<T> *> &stops,
+                          const std::vector<Vertex<T> *> &nodesToAvoid, const std::vector<Edge<T> *> &segmentsToAvoid,
+                          const WeightPolicy &weight, std::vector<SearchWorkspace<T>> &searches,
+                          unsigned numThreads = 0) {
+    if (stops.size() < 2) return Path<T>();
+    std::vector<Path<T>> legs(stops.size() - 1);
+
+    if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t numWorkers = std::min<size_t>(numThreads, legs.size());
+    if (searches.size() < numWorkers) searches.resize(numWorkers);
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numWorkers; i++) {
+        workers.emplace_back(searchLegs<T, WeightPolicy>, g, std::cref(stops), std::cref(nodesToAvoid),
+                             std::cref(segmentsToAvoid), std::cref(weight), std::ref(searches[i]), std::ref(next),
+                             std::ref(legs));
+    }
+    searchLegs(g, stops, nodesToAvoid, segmentsToAvoid, weight, searches[0], next, legs);
+    for (std::thread &worker : workers) worker.join();
+
+    Path<T> route;
+    for (const Path<T> &leg : legs) {
+        if (leg.empty()) return Path<T>(); // No route reaches the next stop
+        route.append(leg);
+    }
+    return route;
+}
+
+#endif //WAYPOINTS_H
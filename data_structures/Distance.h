@@ -0,0 +1,67 @@
+/**
+ * @file Distance.h
+ * @brief Integer types for edge weights and path distances.
+ *
+ * Travel times are whole minutes, so edges store them as 16-bit weights and searches accumulate them in an
+ * unsigned Distance with saturating addition. Both types reserve their largest value: IMPASSABLE marks an
+ * edge that cannot be used in a mode (the "X" of Distances.csv) and UNREACHABLE a vertex a search did not
+ * reach. Adding anything to UNREACHABLE, or IMPASSABLE to anything, gives UNREACHABLE.
+ *
+ * Distance is 32 bits wide unless the project is configured with DA_DISTANCE_BITS=16, which halves the
+ * memory a search touches for graphs whose routes stay under 65535 minutes; longer routes saturate to
+ * UNREACHABLE instead of wrapping around.
+ */
+
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Travel time of one edge, in minutes.
+ */
+typedef uint16_t Weight;
+
+/**
+ * @brief Weight of an edge that cannot be used, such as a pedestrian-only segment when driving.
+ */
+const Weight IMPASSABLE = std::numeric_limits<Weight>::max();
+
+#if defined(DA_DISTANCE_BITS) && DA_DISTANCE_BITS == 16
+typedef uint16_t Distance;
+#else
+/**
+ * @brief Total travel time of a path, in minutes.
+ */
+typedef uint32_t Distance;
+#endif
+
+/**
+ * @brief Distance of a vertex that cannot be reached.
+ */
+const Distance UNREACHABLE = std::numeric_limits<Distance>::max();
+
+/**
+ * @brief Adds two unsigned values, clamping at the largest value of the type instead of wrapping around.
+ */
+template <class D>
+D saturatingAdd(D a, D b) {
+    return a > std::numeric_limits<D>::max() - b ? std::numeric_limits<D>::max() : static_cast<D>(a + b);
+}
+
+/**
+ * @brief Converts an edge weight to a distance, mapping IMPASSABLE to UNREACHABLE.
+ */
+inline Distance toDistance(Weight w) {
+    return w == IMPASSABLE ? UNREACHABLE : static_cast<Distance>(w);
+}
+
+/**
+ * @brief Tells whether a value read from an input file is a usable edge weight.
+ */
+inline bool isValidWeight(int minutes) {
+    return minutes >= 0 && minutes < IMPASSABLE;
+}
+
+#endif //DISTANCE_H
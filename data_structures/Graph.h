@@ -13,116 +13,187 @@
 #include <unordered_map>
 #include <unordered_set>
 
-#include "../data_structures/MutablePriorityQueue.h" // not needed for now
+#include "StringPool.h"
+#include "Distance.h"
 
 template <class T>
 class Edge;
 
-#define INF std::numeric_limits<double>::max()
+template <class T>
+class Graph;
+
+template <class T>
+class GraphBuilder;
+
+template <class T>
+struct Segment;
+
+template <class T>
+struct DirectedEdge;
 
 /************************* Vertex  **************************/
 
+/*
+ * The fields a search reads on every step (adjacency, position and the search state) come first, so they
+ * share the first cache lines of a vertex; names, the parking flag and the incoming edges, which searches
+ * do not touch, come last.
+ */
 template <class T>
 class Vertex {
 public:
-    Vertex(T in, std::string location = "", std::string code = "", bool hasParking = false);
-    bool operator<(Vertex<T> & vertex) const; // // required by MutablePriorityQueue
-
-    int getID() const { return ID; }
-    std::string getCode() const { return code; }
-    std::string getLocation() const { return location; }
+    Vertex(T in, Symbol location = Symbol(), Symbol code = Symbol(), bool hasParking = false);
+
+    int getIndex() const { return index; }
+    void setIndex(int index) { this->index = index; }
+    std::string getCode() const { return code.str(); }
+    std::string getLocation() const { return location.str(); }
+    Symbol getCodeSymbol() const { return code; }
+    Symbol getLocationSymbol() const { return location; }
     bool getParking() const { return hasParking; }
 
     T getInfo() const;
-    std::vector<Edge<T> *> getAdj() const;
+    const std::vector<Edge<T> *> &getAdj() const;
+    /*
+     * Outgoing edges usable in one mode, in the order of getAdj(): the driving list leaves out segments whose
+     * driving time is IMPASSABLE (the walking list, those whose walking time is), so searches in that mode
+     * never scan them. Both lists follow edges as they are added, removed or change times.
+     */
+    const std::vector<Edge<T> *> &getDrivingAdj() const { return drivingAdj; }
+    const std::vector<Edge<T> *> &getWalkingAdj() const { return walkingAdj; }
     bool isVisited() const;
-    bool isProcessing() const;
-    unsigned int getIndegree() const;
-    double getDist() const;
+    Distance getDist() const;
     Edge<T> *getPath() const;
-    std::vector<Edge<T> *> getIncoming() const;
+    const std::vector<Edge<T> *> &getIncoming() const;
 
     void setInfo(T info);
     void setVisited(bool visited);
-    void setProcessing(bool processing);
-
-    int getLow() const;
-    void setLow(int value);
-    int getNum() const;
-    void setNum(int value);
-
-    void setIndegree(unsigned int indegree);
-    void setDist(double dist);
+    void setDist(Distance dist);
     void setPath(Edge<T> *path);
-    Edge<T> * addEdge(Vertex<T> *d, int drivingTime, int walkingTime);
+    Edge<T> * addEdge(Vertex<T> *d, Weight drivingTime, Weight walkingTime);
     bool removeEdge(T in);
+    bool removeEdge(Edge<T> *edge);
     void removeOutgoingEdges();
 
-    friend class MutablePriorityQueue<Vertex>;
+    friend class Graph<T>;
+    friend class Edge<T>;
 protected:
-    T info;                // info node
+    // hot: read by searches
     std::vector<Edge<T> *> adj;  // outgoing edges
-
-    int ID;
-    std::string code;
-    std::string location;
-    bool hasParking;
-
-    // auxiliary fields
-    bool visited = false; // used by DFS, BFS, Prim ...
-    bool processing = false; // used by isDAG (in addition to the visited attribute)
-    int low = -1, num = -1; // used by SCC Tarjan
-    unsigned int indegree; // used by topsort
-    double dist = 0;
+    std::vector<Edge<T> *> drivingAdj; // outgoing edges that can be driven
+    std::vector<Edge<T> *> walkingAdj; // outgoing edges that can be walked
+    int index = -1; // position in the graph's vertex set
+    Distance dist = 0;
+    T info;                // info node
+    bool visited = false;
     Edge<T> *path = nullptr;
 
+    // cold: metadata
+    Symbol code;     // interned in the graph's StringPool
+    Symbol location;
+    bool hasParking;
     std::vector<Edge<T> *> incoming; // incoming edges
 
-    int queueIndex = 0; 		// required by MutablePriorityQueue and UFDS
-
+    void attachEdge(Edge<T> *edge);
     void deleteEdge(Edge<T> *edge);
+    void refreshModeAdj();
 };
 
 /********************** Edge  ****************************/
 
+/*
+ * One direction of travel between two vertices.
+ *
+ * A two-way segment (Graph::addEdge) is stored once, as a Segment that holds both directions and a single
+ * copy of the times, so changing the times of either direction changes both. A one-way edge
+ * (Graph::addDirectedEdge, or a direction split off a segment with Graph::makeDirected) is a DirectedEdge
+ * with its own origin, times and optional reverse. Both kinds are used through this class alone.
+ */
 template <class T>
 class Edge {
 public:
-    Edge(Vertex<T> *orig, Vertex<T> *dest, int drivingTime, int walkingTime);
-
     Vertex<T> * getDest() const;
-    double getWeight() const;
-
-    int getDrivingTime() const { return drivingTime; }
-    int getWalkingTime() const { return walkingTime; }
-
-    bool isSelected() const;
     Vertex<T> * getOrig() const;
     Edge<T> *getReverse() const;
-    double getFlow() const;
 
-    void setSelected(bool selected);
+    Weight getDrivingTime() const;
+    Weight getWalkingTime() const;
+    int getIndex() const { return index; }
+
+    /*
+     * True for a direction of a two-way segment stored once, false for a one-way edge.
+     */
+    bool isUndirected() const { return kind != DIRECTED; }
+
+    /*
+     * Pairs a one-way edge with the edge in the opposite direction. The directions of a segment are
+     * always each other's reverse, and ignore this.
+     */
     void setReverse(Edge<T> *reverse);
-    void setFlow(double flow);
+    void setIndex(int index) { this->index = index; }
+    void setDrivingTime(Weight drivingTime);
+    void setWalkingTime(Weight walkingTime);
+
+    friend class Graph<T>;
+    friend class Vertex<T>;
+    friend struct Segment<T>;
+    friend struct DirectedEdge<T>;
 protected:
+    enum Kind : uint8_t { FORWARD, BACKWARD, DIRECTED }; // FORWARD and BACKWARD are the two halves of a Segment
+
+    Edge(Vertex<T> *dest, Kind kind) : dest(dest), kind(kind) {}
+
     Vertex<T> * dest; // destination vertex
-    double weight; // edge weight, can also be used for capacity
+    int index = -1; // position in the graph's edge numbering, see Graph::getNumEdges
+    Kind kind;
+    bool detached = false; // removed from the graph while the other direction of its segment remains
+
+    Segment<T> *segment() const;
+    DirectedEdge<T> *directed() const;
+    void refreshEnds();
+    static void destroy(Edge<T> *edge);
+};
 
-    // auxiliary fields
-    bool selected = false;
+/*
+ * A two-way segment: both directions and their common times in one allocation.
+ */
+template <class T>
+struct Segment {
+    Edge<T> halves[2]; // orig -> dest, then dest -> orig; must stay the first member (see Edge::segment)
+    Weight drivingTime; // IMPASSABLE for segments that can only be walked
+    Weight walkingTime;
 
-    // used for bidirectional edges
+    Segment(Vertex<T> *orig, Vertex<T> *dest, Weight drivingTime, Weight walkingTime)
+        : halves{Edge<T>(dest, Edge<T>::FORWARD), Edge<T>(orig, Edge<T>::BACKWARD)},
+          drivingTime(drivingTime), walkingTime(walkingTime) {}
+};
+
+/*
+ * A one-way edge, with its own origin and times.
+ */
+template <class T>
+struct DirectedEdge : public Edge<T> {
     Vertex<T> *orig;
     Edge<T> *reverse = nullptr;
+    Weight drivingTime; // IMPASSABLE for segments that can only be walked
+    Weight walkingTime;
 
-    int drivingTime;
-    int walkingTime;
-
-    double flow; // for flow-related problems
+    DirectedEdge(Vertex<T> *orig, Vertex<T> *dest, Weight drivingTime, Weight walkingTime)
+        : Edge<T>(dest, Edge<T>::DIRECTED), orig(orig), drivingTime(drivingTime), walkingTime(walkingTime) {}
 };
 
 /********************** Graph  ****************************/
 
+/*
+ * A segment to be added by Graph::addEdges, equivalent to one call of addEdge.
+ */
+template <class T>
+struct SegmentInput {
+    Vertex<T> *orig;
+    Vertex<T> *dest;
+    Weight drivingTime;
+    Weight walkingTime;
+};
+
 template <class T>
 class Graph {
 public:
@@ -133,6 +204,12 @@ public:
     Vertex<T> *findVertex(const T &in) const;
 
     Vertex<T> *findVertex(std::string location) const;
+    Vertex<T> *findVertex(Symbol location) const;
+
+    /*
+     * Finds the vertex with a given location code, or returns nullptr.
+     */
+    Vertex<T> *findVertexByCode(const std::string &code) const;
 
     Edge<T> *findEdge(std::string orig, std::string dest) const;
     /*
@@ -141,59 +218,119 @@ public:
      */
     bool addVertex(const T &in, const std::string &location, const std::string &code, bool hasParking);
     bool removeVertex(const T &in);
+    bool removeVertex(Vertex<T> *v);
 
     /*
-     * Adds an edge to a graph (this), given the contents of the source and
-     * destination vertices and the edge weight (w).
+     * Adds a two-way segment to a graph (this), given its end vertices and its times.
+     * The segment is stored once and both directions (src -> dst, then dst -> src) get the next edge indices.
      * Returns true if successful, and false if the source or destination vertex does not exist.
      */
-    bool addEdge(Vertex<T> *src, Vertex<T> *dst, int drivingTime, int walkingTime);
+    bool addEdge(Vertex<T> *src, Vertex<T> *dst, Weight drivingTime, Weight walkingTime);
+
+    /*
+     * Adds a single directed edge and gives it the next edge index.
+     * Used for one-way streets and to rebuild a graph with a given adjacency order; pair both directions
+     * with setReverse.
+     */
+    Edge<T> *addDirectedEdge(Vertex<T> *src, Vertex<T> *dst, Weight drivingTime, Weight walkingTime);
+
+    /*
+     * Stores the directions of a two-way segment as separate one-way edges, so that each direction can get
+     * its own times or be removed on its own. Edge indices and adjacency order are kept, but pointers to the
+     * old directions are not. Returns the edge that replaces the given direction (the edge itself if it was
+     * already one-way).
+     */
+    Edge<T> *makeDirected(Edge<T> *edge);
+
+    /*
+     * The opposite of makeDirected: stores a one-way edge and its reverse as a single two-way segment, if they
+     * have the same times. Edge indices and adjacency order are kept, but pointers to the old edges are not.
+     * Returns the direction that replaces the given edge, or nullptr if the edges cannot be merged.
+     */
+    Edge<T> *makeUndirected(Edge<T> *edge);
+
+    /*
+     * Adds a batch of segments in order, exactly as the same sequence of addEdge calls would,
+     * but sizes the adjacency lists of every vertex once up front instead of growing them edge by edge.
+     * Returns the number of segments added; segments with a missing vertex are skipped.
+     */
+    int addEdges(const std::vector<SegmentInput<T>> &segments);
+
+    /*
+     * Moves the vertices to new positions in the vertex set: order[i] is the current position of the vertex
+     * that goes to position i, and must list every position exactly once. Edge indices are then handed out
+     * again in vertex and adjacency order, so the edges leaving a vertex get consecutive indices; the order of
+     * each adjacency list is kept.
+     * Vertices keep their contents, codes and names, so lookups by Id, code or name are unaffected. Positions
+     * and edge indices held outside the graph (paths, weight versions, penalties) are not, and must be
+     * translated or rebuilt.
+     * Returns the new position of the vertex at each old position, or an empty vector (and changes nothing)
+     * if order is not a permutation of the positions.
+     */
+    std::vector<int> renumber(const std::vector<int> &order);
 
     bool removeEdge(const T &source, const T &dest);
-    bool addBidirectionalEdge(const T &sourc, const T &dest, double w);
+    bool removeEdge(Edge<T> *edge);
 
     int getNumVertex() const;
-    std::vector<Vertex<T> *> getVertexSet() const;
-
+    /*
+     * Number of edge indices handed out so far. Every edge gets a unique index
+     * in [0, getNumEdges()) when it is added; indices of removed edges are not reused.
+     */
+    int getNumEdges() const { return numEdges; }
+    /*
+     * The containers returned by getVertexSet, Vertex::getAdj and Vertex::getIncoming are the graph's own:
+     * iterating them does not allocate, and they must not be held across a change to the graph.
+     */
+    const std::vector<Vertex<T> *> &getVertexSet() const;
 
+    /*
+     * Returns one edge per segment.
+     */
     std::vector<Edge<T>*> getEdges() const;
 
-    std::unordered_map<std::string, T> codeToId;
+    StringPool names;                  // location names and codes of the vertices
+    std::unordered_map<Symbol, T> codeToId;
 
+    friend class GraphBuilder<T>;
 protected:
     std::vector<Vertex<T> *> vertexSet;    // vertex set
+    std::unordered_map<T, Vertex<T> *> vertexMap; // vertex by content, for findVertex
+    int numEdges = 0;                      // next edge index to hand out
 
-    double ** distMatrix = nullptr;   // dist matrix for Floyd-Warshall
-    int **pathMatrix = nullptr;   // path matrix for Floyd-Warshall
-
-    /*
-     * Finds the index of the vertex with a given content.
-     */
-    int findVertexIdx(const T &in) const;
+    void replaceEdge(Edge<T> *old, Edge<T> *replacement);
 };
 
-void deleteMatrix(int **m, int n);
-void deleteMatrix(double **m, int n);
-
 
 /************************* Vertex  **************************/
 
 template <class T>
-Vertex<T>::Vertex(T in, std::string name, std::string code, bool parking)
-    : info(in), location(std::move(name)), code(std::move(code)), hasParking(parking) {}
+Vertex<T>::Vertex(T in, Symbol name, Symbol code, bool parking)
+    : info(in), code(code), location(name), hasParking(parking) {}
 
 /*
  * Auxiliary function to add an outgoing edge to a vertex (this),
  * with a given destination vertex (d) and edge weight (w).
  */
 template <class T>
-Edge<T> * Vertex<T>::addEdge(Vertex<T> *d, int drivingTime, int walkingTime) {
-    auto newEdge = new Edge<T>(this, d, drivingTime, walkingTime); // ✅ Pass both weights
-    adj.push_back(newEdge);
-    d->incoming.push_back(newEdge);
+Edge<T> * Vertex<T>::addEdge(Vertex<T> *d, Weight drivingTime, Weight walkingTime) {
+    Edge<T> *newEdge = new DirectedEdge<T>(this, d, drivingTime, walkingTime);
+    attachEdge(newEdge);
     return newEdge;
 }
 
+/*
+ * Appends an edge leaving this vertex to the adjacency lists it belongs in and to the incoming
+ * edges of its destination.
+ */
+template <class T>
+void Vertex<T>::attachEdge(Edge<T> *edge) {
+    adj.push_back(edge);
+    if (edge->getDrivingTime() != IMPASSABLE) drivingAdj.push_back(edge);
+    if (edge->getWalkingTime() != IMPASSABLE) walkingAdj.push_back(edge);
+    edge->getDest()->incoming.push_back(edge);
+}
+
 
 /*
  * Auxiliary function to remove an outgoing edge (with a given destination (d))
@@ -219,6 +356,19 @@ bool Vertex<T>::removeEdge(T in) {
     return removedEdge;
 }
 
+/*
+ * Removes one outgoing edge of a vertex (this), leaving any parallel edges to the same vertex.
+ * Returns true if successful, and false if the edge does not leave this vertex.
+ */
+template <class T>
+bool Vertex<T>::removeEdge(Edge<T> *edge) {
+    auto it = std::find(adj.begin(), adj.end(), edge);
+    if (it == adj.end()) return false;
+    adj.erase(it);
+    deleteEdge(edge);
+    return true;
+}
+
 /*
  * Auxiliary function to remove an outgoing edge of a vertex.
  */
@@ -232,38 +382,13 @@ void Vertex<T>::removeOutgoingEdges() {
     }
 }
 
-template <class T>
-bool Vertex<T>::operator<(Vertex<T> & vertex) const {
-    return this->dist < vertex.dist;
-}
-
 template <class T>
 T Vertex<T>::getInfo() const {
     return this->info;
 }
 
 template <class T>
-int Vertex<T>::getLow() const {
-    return this->low;
-}
-
-template <class T>
-void Vertex<T>::setLow(int value) {
-    this->low = value;
-}
-
-template <class T>
-int Vertex<T>::getNum() const {
-    return this->num;
-}
-
-template <class T>
-void Vertex<T>::setNum(int value) {
-    this->num = value;
-}
-
-template <class T>
-std::vector<Edge<T>*> Vertex<T>::getAdj() const {
+const std::vector<Edge<T>*> &Vertex<T>::getAdj() const {
     return this->adj;
 }
 
@@ -273,17 +398,7 @@ bool Vertex<T>::isVisited() const {
 }
 
 template <class T>
-bool Vertex<T>::isProcessing() const {
-    return this->processing;
-}
-
-template <class T>
-unsigned int Vertex<T>::getIndegree() const {
-    return this->indegree;
-}
-
-template <class T>
-double Vertex<T>::getDist() const {
+Distance Vertex<T>::getDist() const {
     return this->dist;
 }
 
@@ -293,7 +408,7 @@ Edge<T> *Vertex<T>::getPath() const {
 }
 
 template <class T>
-std::vector<Edge<T> *> Vertex<T>::getIncoming() const {
+const std::vector<Edge<T> *> &Vertex<T>::getIncoming() const {
     return this->incoming;
 }
 
@@ -308,17 +423,7 @@ void Vertex<T>::setVisited(bool visited) {
 }
 
 template <class T>
-void Vertex<T>::setProcessing(bool processing) {
-    this->processing = processing;
-}
-
-template <class T>
-void Vertex<T>::setIndegree(unsigned int indegree) {
-    this->indegree = indegree;
-}
-
-template <class T>
-void Vertex<T>::setDist(double dist) {
+void Vertex<T>::setDist(Distance dist) {
     this->dist = dist;
 }
 
@@ -329,69 +434,122 @@ void Vertex<T>::setPath(Edge<T> *path) {
 
 template <class T>
 void Vertex<T>::deleteEdge(Edge<T> *edge) {
+    for (std::vector<Edge<T> *> *mode : {&drivingAdj, &walkingAdj}) {
+        auto found = std::find(mode->begin(), mode->end(), edge);
+        if (found != mode->end()) mode->erase(found);
+    }
+
     Vertex<T> *dest = edge->getDest();
-    // Remove the corresponding edge from the incoming list
-    auto it = dest->incoming.begin();
-    while (it != dest->incoming.end()) {
-        if ((*it)->getOrig()->getInfo() == info) {
-            it = dest->incoming.erase(it);
-        }
-        else {
-            it++;
-        }
+    // Remove the corresponding edge from the incoming list, keeping parallel edges from this vertex
+    auto it = std::find(dest->incoming.begin(), dest->incoming.end(), edge);
+    if (it != dest->incoming.end()) dest->incoming.erase(it);
+    Edge<T>::destroy(edge);
+}
+
+/*
+ * Rebuilds the per-mode adjacency lists from adj, after an edge became usable or unusable in a mode.
+ */
+template <class T>
+void Vertex<T>::refreshModeAdj() {
+    drivingAdj.clear();
+    walkingAdj.clear();
+    for (Edge<T> *e : adj) {
+        if (e->getDrivingTime() != IMPASSABLE) drivingAdj.push_back(e);
+        if (e->getWalkingTime() != IMPASSABLE) walkingAdj.push_back(e);
     }
-    delete edge;
 }
 
 /********************** Edge  ****************************/
 
+/*
+ * The segment a direction belongs to: the halves are the first member of a Segment, so the forward half
+ * starts at the same address as its segment.
+ */
 template <class T>
-Edge<T>::Edge(Vertex<T> *orig, Vertex<T> *dest, int drivingTime, int walkingTime)
-    : orig(orig), dest(dest), drivingTime(drivingTime), walkingTime(walkingTime) {}
+Segment<T> *Edge<T>::segment() const {
+    return reinterpret_cast<Segment<T> *>(const_cast<Edge<T> *>(this) - kind);
+}
 
 template <class T>
-Vertex<T> * Edge<T>::getDest() const {
-    return this->dest;
+DirectedEdge<T> *Edge<T>::directed() const {
+    return static_cast<DirectedEdge<T> *>(const_cast<Edge<T> *>(this));
 }
 
 template <class T>
-double Edge<T>::getWeight() const {
-    return this->weight;
+Vertex<T> * Edge<T>::getDest() const {
+    return this->dest;
 }
 
 template <class T>
 Vertex<T> * Edge<T>::getOrig() const {
-    return this->orig;
+    if (kind == DIRECTED) return directed()->orig;
+    return segment()->halves[1 - kind].dest;
 }
 
 template <class T>
 Edge<T> *Edge<T>::getReverse() const {
-    return this->reverse;
+    if (kind == DIRECTED) return directed()->reverse;
+    Edge<T> *other = &segment()->halves[1 - kind];
+    return other->detached ? nullptr : other;
 }
 
 template <class T>
-bool Edge<T>::isSelected() const {
-    return this->selected;
+Weight Edge<T>::getDrivingTime() const {
+    return kind == DIRECTED ? directed()->drivingTime : segment()->drivingTime;
 }
 
 template <class T>
-double Edge<T>::getFlow() const {
-    return flow;
+Weight Edge<T>::getWalkingTime() const {
+    return kind == DIRECTED ? directed()->walkingTime : segment()->walkingTime;
 }
 
 template <class T>
-void Edge<T>::setSelected(bool selected) {
-    this->selected = selected;
+void Edge<T>::setReverse(Edge<T> *reverse) {
+    if (kind == DIRECTED) directed()->reverse = reverse;
 }
 
 template <class T>
-void Edge<T>::setReverse(Edge<T> *reverse) {
-    this->reverse = reverse;
+void Edge<T>::setDrivingTime(Weight drivingTime) {
+    Weight &time = kind == DIRECTED ? directed()->drivingTime : segment()->drivingTime;
+    bool wasUsable = time != IMPASSABLE;
+    time = drivingTime;
+    if (wasUsable != (drivingTime != IMPASSABLE)) refreshEnds();
 }
 
 template <class T>
-void Edge<T>::setFlow(double flow) {
-    this->flow = flow;
+void Edge<T>::setWalkingTime(Weight walkingTime) {
+    Weight &time = kind == DIRECTED ? directed()->walkingTime : segment()->walkingTime;
+    bool wasUsable = time != IMPASSABLE;
+    time = walkingTime;
+    if (wasUsable != (walkingTime != IMPASSABLE)) refreshEnds();
+}
+
+/*
+ * Updates the per-mode adjacency lists of every vertex this edge's times apply to.
+ */
+template <class T>
+void Edge<T>::refreshEnds() {
+    getOrig()->refreshModeAdj();
+    if (kind != DIRECTED) dest->refreshModeAdj();
+}
+
+/*
+ * Frees an edge that was removed from the graph. The directions of a segment share their memory,
+ * which is freed with the second one; a one-way edge is unpaired from its reverse first.
+ */
+template <class T>
+void Edge<T>::destroy(Edge<T> *edge) {
+    if (edge->kind == DIRECTED) {
+        Edge<T> *reverse = edge->directed()->reverse;
+        if (reverse != nullptr && reverse->kind == DIRECTED && reverse->directed()->reverse == edge) {
+            reverse->directed()->reverse = nullptr;
+        }
+        delete edge->directed();
+        return;
+    }
+    Segment<T> *segment = edge->segment();
+    if (segment->halves[1 - edge->kind].detached) delete segment;
+    else edge->detached = true;
 }
 
 /********************** Graph  ****************************/
@@ -402,7 +560,7 @@ int Graph<T>::getNumVertex() const {
 }
 
 template <class T>
-std::vector<Vertex<T> *> Graph<T>::getVertexSet() const {
+const std::vector<Vertex<T> *> &Graph<T>::getVertexSet() const {
     return vertexSet;
 }
 
@@ -431,26 +589,41 @@ std::vector<Edge<T>*> Graph<T>::getEdges() const {
  */
 template <class T>
 Vertex<T> * Graph<T>::findVertex(const T &in) const {
-    for (auto v : vertexSet)
-        if (v->getInfo() == in)
-            return v;
-    return nullptr;
+    auto it = vertexMap.find(in);
+    return it == vertexMap.end() ? nullptr : it->second;
 }
 
 template <class T>
 Vertex<T> *Graph<T>::findVertex(std::string location) const {
+    Symbol name = names.find(location);
+    return names.found(name) ? findVertex(name) : nullptr;
+}
+
+template <class T>
+Vertex<T> *Graph<T>::findVertex(Symbol location) const {
     for (auto v : vertexSet)
-        if (v->getLocation() == location)
+        if (v->location == location)
             return v;
     return nullptr;
 }
 
+template <class T>
+Vertex<T> *Graph<T>::findVertexByCode(const std::string &code) const {
+    Symbol name = names.find(code);
+    if (!names.found(name)) return nullptr;
+    auto it = codeToId.find(name);
+    return it == codeToId.end() ? nullptr : findVertex(it->second);
+}
+
 template<class T>
 Edge<T> *Graph<T>::findEdge(std::string orig, std::string dest) const {
+    Symbol origName = names.find(orig);
+    Symbol destName = names.find(dest);
+    if (!names.found(origName) || !names.found(destName)) return nullptr;
     for (auto v : vertexSet) {
-        if (v->getLocation() == orig) {
-            for (auto e : v->getAdj()) {
-                if (e->getDest()->getLocation() == dest) {
+        if (v->location == origName) {
+            for (auto e : v->adj) {
+                if (e->getDest()->location == destName) {
                     return e;
                 }
             }
@@ -459,27 +632,21 @@ Edge<T> *Graph<T>::findEdge(std::string orig, std::string dest) const {
     return nullptr;
 }
 
-
-/*
- * Finds the index of the vertex with a given content.
- */
-template <class T>
-int Graph<T>::findVertexIdx(const T &in) const {
-    for (unsigned i = 0; i < vertexSet.size(); i++)
-        if (vertexSet[i]->getInfo() == in)
-            return i;
-    return -1;
-}
 /*
  *  Adds a vertex with a given content or info (in) to a graph (this).
  *  Returns true if successful, and false if a vertex with that content already exists.
  */
 template <class T>
-bool Graph<T>::addVertex(const T &in, const std::string &location, const std::string &code, bool parking) {
+bool Graph<T>::addVertex(const T &in, const std::string &location, const std::string &code, bool hasParking) {
     if (findVertex(in) != nullptr)
         return false; // Vertex already exists
 
-    vertexSet.push_back(new Vertex<T>(in, location, code, parking));
+    Symbol codeName = names.intern(code);
+    auto v = new Vertex<T>(in, names.intern(location), codeName, hasParking);
+    v->setIndex(vertexSet.size());
+    vertexSet.push_back(v);
+    vertexMap[in] = v;
+    codeToId[codeName] = in;
     return true;
 }
 
@@ -490,19 +657,36 @@ bool Graph<T>::addVertex(const T &in, const std::string &location, const std::st
  */
 template <class T>
 bool Graph<T>::removeVertex(const T &in) {
-    for (auto it = vertexSet.begin(); it != vertexSet.end(); it++) {
-        if ((*it)->getInfo() == in) {
-            auto v = *it;
-            v->removeOutgoingEdges();
-            for (auto u : vertexSet) {
-                u->removeEdge(v->getInfo());
-            }
-            vertexSet.erase(it);
-            delete v;
-            return true;
-        }
+    Vertex<T> *v = findVertex(in);
+    return v != nullptr && removeVertex(v);
+}
+
+/*
+ *  Removes a vertex of this graph, as above, when the caller already has it.
+ */
+template <class T>
+bool Graph<T>::removeVertex(Vertex<T> *v) {
+    const T in = v->getInfo();
+
+    // Only the neighbours can have edges to v
+    std::vector<Vertex<T> *> sources;
+    for (Edge<T> *e : v->incoming) {
+        if (std::find(sources.begin(), sources.end(), e->getOrig()) == sources.end()) sources.push_back(e->getOrig());
     }
-    return false;
+    v->removeOutgoingEdges();
+    for (Vertex<T> *u : sources) {
+        u->removeEdge(in);
+    }
+
+    auto it = vertexSet.erase(vertexSet.begin() + v->getIndex());
+    for (; it != vertexSet.end(); it++) {
+        (*it)->setIndex((*it)->getIndex() - 1);
+    }
+    vertexMap.erase(in);
+    auto code = codeToId.find(v->getCodeSymbol());
+    if (code != codeToId.end() && code->second == in) codeToId.erase(code);
+    delete v;
+    return true;
 }
 
 /*
@@ -511,20 +695,124 @@ bool Graph<T>::removeVertex(const T &in) {
  * Returns true if successful, and false if the source or destination vertex does not exist.
  */
 template <class T>
-bool Graph<T>::addEdge(Vertex<T> *src, Vertex<T> *dst, int drivingTime, int walkingTime) {
+bool Graph<T>::addEdge(Vertex<T> *src, Vertex<T> *dst, Weight drivingTime, Weight walkingTime) {
     if (!src || !dst) return false;
 
-    Edge<T> *edge1 = src->addEdge(dst, drivingTime, walkingTime);
+    auto segment = new Segment<T>(src, dst, drivingTime, walkingTime);
+    src->attachEdge(&segment->halves[0]);
+    dst->attachEdge(&segment->halves[1]);
+    segment->halves[0].setIndex(numEdges++);
+    segment->halves[1].setIndex(numEdges++);
 
-    Edge<T> *edge2 = dst->addEdge(src, drivingTime, walkingTime);
+    return true;
+}
 
-    edge1->setReverse(edge2);
-    edge2->setReverse(edge1);
 
-    return true;
+template <class T>
+Edge<T> *Graph<T>::addDirectedEdge(Vertex<T> *src, Vertex<T> *dst, Weight drivingTime, Weight walkingTime) {
+    if (!src || !dst) return nullptr;
+    Edge<T> *edge = src->addEdge(dst, drivingTime, walkingTime);
+    edge->setIndex(numEdges++);
+    return edge;
+}
+
+/*
+ * Puts an edge in the place of another with the same ends and times in every list that holds it.
+ */
+template <class T>
+void Graph<T>::replaceEdge(Edge<T> *old, Edge<T> *replacement) {
+    Vertex<T> *orig = old->getOrig();
+    for (std::vector<Edge<T> *> *edges : {&orig->adj, &orig->drivingAdj, &orig->walkingAdj, &old->getDest()->incoming}) {
+        std::replace(edges->begin(), edges->end(), old, replacement);
+    }
+}
+
+template <class T>
+Edge<T> *Graph<T>::makeDirected(Edge<T> *edge) {
+    if (!edge->isUndirected()) return edge;
+
+    Segment<T> *segment = edge->segment();
+    DirectedEdge<T> *split[2] = {nullptr, nullptr};
+    for (int side = 0; side < 2; side++) {
+        Edge<T> *half = &segment->halves[side];
+        if (half->detached) continue;
+        split[side] = new DirectedEdge<T>(half->getOrig(), half->getDest(), segment->drivingTime, segment->walkingTime);
+        split[side]->setIndex(half->getIndex());
+        replaceEdge(half, split[side]);
+    }
+    if (split[0] && split[1]) {
+        split[0]->reverse = split[1];
+        split[1]->reverse = split[0];
+    }
+
+    Edge<T> *result = split[edge->kind];
+    delete segment;
+    return result;
+}
+
+template <class T>
+Edge<T> *Graph<T>::makeUndirected(Edge<T> *edge) {
+    Edge<T> *reverse = edge->getReverse();
+    if (edge->isUndirected()) return edge;
+    if (reverse == nullptr || reverse->isUndirected() || reverse->getReverse() != edge
+        || edge->getDrivingTime() != reverse->getDrivingTime() || edge->getWalkingTime() != reverse->getWalkingTime()) {
+        return nullptr;
+    }
+
+    auto segment = new Segment<T>(edge->getOrig(), edge->getDest(), edge->getDrivingTime(), edge->getWalkingTime());
+    segment->halves[0].setIndex(edge->getIndex());
+    segment->halves[1].setIndex(reverse->getIndex());
+    replaceEdge(edge, &segment->halves[0]);
+    replaceEdge(reverse, &segment->halves[1]);
+    Edge<T>::destroy(edge);
+    Edge<T>::destroy(reverse);
+    return &segment->halves[0];
+}
+template <class T>
+int Graph<T>::addEdges(const std::vector<SegmentInput<T>> &segments) {
+    std::vector<size_t> degree(vertexSet.size(), 0);
+    for (const SegmentInput<T> &s : segments) {
+        if (!s.orig || !s.dest) continue;
+        degree[s.orig->getIndex()]++;
+        degree[s.dest->getIndex()]++;
+    }
+    for (Vertex<T> *v : vertexSet) {
+        if (degree[v->getIndex()] == 0) continue;
+        v->adj.reserve(v->adj.size() + degree[v->getIndex()]);
+        v->drivingAdj.reserve(v->drivingAdj.size() + degree[v->getIndex()]);
+        v->walkingAdj.reserve(v->walkingAdj.size() + degree[v->getIndex()]);
+        v->incoming.reserve(v->incoming.size() + degree[v->getIndex()]);
+    }
+
+    int added = 0;
+    for (const SegmentInput<T> &s : segments) {
+        if (addEdge(s.orig, s.dest, s.drivingTime, s.walkingTime)) added++;
+    }
+    return added;
 }
 
+template <class T>
+std::vector<int> Graph<T>::renumber(const std::vector<int> &order) {
+    std::vector<int> newPosition(vertexSet.size(), -1);
+    if (order.size() != vertexSet.size()) return {};
+    for (size_t i = 0; i < order.size(); i++) {
+        if (order[i] < 0 || order[i] >= (int) vertexSet.size() || newPosition[order[i]] != -1) return {};
+        newPosition[order[i]] = i;
+    }
 
+    std::vector<Vertex<T> *> reordered(vertexSet.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        reordered[i] = vertexSet[order[i]];
+        reordered[i]->setIndex(i);
+    }
+    vertexSet.swap(reordered);
+
+    numEdges = 0;
+    for (Vertex<T> *v : vertexSet) {
+        for (Edge<T> *e : v->adj) e->setIndex(numEdges++);
+    }
+    return newPosition;
+}
 
 /*
  * Removes an edge from a graph (this).
@@ -540,41 +828,21 @@ bool Graph<T>::removeEdge(const T &sourc, const T &dest) {
     return srcVertex->removeEdge(dest);
 }
 
+/*
+ * Removes one edge from a graph (this), leaving any parallel edges between the same vertices.
+ * Returns true if successful, and false if the edge is not in the graph.
+ */
 template <class T>
-bool Graph<T>::addBidirectionalEdge(const T &sourc, const T &dest, double w) {
-    auto v1 = findVertex(sourc);
-    auto v2 = findVertex(dest);
-    if (v1 == nullptr || v2 == nullptr)
-        return false;
-    auto e1 = v1->addEdge(v2, w);
-    auto e2 = v2->addEdge(v1, w);
-    e1->setReverse(e2);
-    e2->setReverse(e1);
-    return true;
-}
-
-inline void deleteMatrix(int **m, int n) {
-    if (m != nullptr) {
-        for (int i = 0; i < n; i++)
-            if (m[i] != nullptr)
-                delete [] m[i];
-        delete [] m;
-    }
-}
-
-inline void deleteMatrix(double **m, int n) {
-    if (m != nullptr) {
-        for (int i = 0; i < n; i++)
-            if (m[i] != nullptr)
-                delete [] m[i];
-        delete [] m;
-    }
+bool Graph<T>::removeEdge(Edge<T> *edge) {
+    return edge != nullptr && edge->getOrig()->removeEdge(edge);
 }
 
 template <class T>
 Graph<T>::~Graph() {
-    deleteMatrix(distMatrix, vertexSet.size());
-    deleteMatrix(pathMatrix, vertexSet.size());
+    for (Vertex<T> *v : vertexSet) {
+        for (Edge<T> *e : v->adj) Edge<T>::destroy(e);
+        delete v;
+    }
 }
 
 #endif /* DA_TP_CLASSES_GRAPH */
\ No newline at end of file
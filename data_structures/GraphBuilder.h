@@ -0,0 +1,170 @@
+/**
+ * @file GraphBuilder.h
+ * @brief Bulk construction of graphs with known sizes.
+ *
+ * Graph::addVertex validates and inserts one vertex at a time and Graph::addEdge grows two adjacency lists
+ * per edge. GraphBuilder collects vertices and segments first, validates all of them at once when build()
+ * is called, and then inserts everything with storage reserved up front.
+ */
+
+#ifndef GRAPH_BUILDER_H
+#define GRAPH_BUILDER_H
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+
+/**
+ * @brief A vertex to be added by GraphBuilder, with the same fields as Graph::addVertex.
+ */
+template <class T>
+struct VertexInput {
+    T info;
+    std::string location;
+    std::string code;
+    bool hasParking;
+};
+
+/**
+ * @brief A segment to be added by GraphBuilder, identified by the contents of its end vertices.
+ */
+template <class T>
+struct SegmentByInfo {
+    T orig;
+    T dest;
+    Weight drivingTime;
+    Weight walkingTime;
+};
+
+/**
+ * @class GraphBuilder
+ * @brief Accumulates vertices and segments and adds them to a graph in one pass.
+ *
+ * Duplicate vertices (by content, also against vertices already in the graph) and segments whose end
+ * vertices do not exist are detected in build() with a single sort and hash lookups.
+ * Rejected items are skipped and described in getErrors().
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class GraphBuilder {
+public:
+    /**
+     * @brief Creates a builder.
+     * @param expectedVertices Number of vertices that will be added, used to reserve storage.
+     * @param expectedSegments Number of segments that will be added, used to reserve storage.
+     */
+    explicit GraphBuilder(size_t expectedVertices = 0, size_t expectedSegments = 0) {
+        vertices.reserve(expectedVertices);
+        segments.reserve(expectedSegments);
+    }
+
+    void addVertex(const T &in, std::string location, std::string code, bool hasParking) {
+        vertices.push_back(VertexInput<T>{in, std::move(location), std::move(code), hasParking});
+    }
+
+    void addVertices(const std::vector<VertexInput<T>> &batch) {
+        vertices.insert(vertices.end(), batch.begin(), batch.end());
+    }
+
+    /**
+     * @brief Adds a two-way segment, as Graph::addEdge does.
+     */
+    void addSegment(const T &orig, const T &dest, Weight drivingTime, Weight walkingTime) {
+        segments.push_back(SegmentByInfo<T>{orig, dest, drivingTime, walkingTime});
+    }
+
+    void addSegments(const std::vector<SegmentByInfo<T>> &batch) {
+        segments.insert(segments.end(), batch.begin(), batch.end());
+    }
+
+    /**
+     * @brief Validates everything added so far and inserts it into a graph.
+     *
+     * Vertices are appended in the order they were added, their names are interned in Graph::names and
+     * their codes registered in Graph::codeToId, and segments are added as by Graph::addEdges.
+     * The builder is empty afterwards.
+     *
+     * @param graph The graph to add to.
+     * @return True if nothing was rejected, false otherwise (see getErrors()).
+     *
+     * @complexity O(N log N + E), where N is the number of vertices added and E the number of segments.
+     */
+    bool build(Graph<T> &graph) {
+        errors.clear();
+
+        // Duplicates among the new vertices: sort their positions by content, keep the first of each run
+        std::vector<size_t> order(vertices.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return vertices[a].info < vertices[b].info;
+        });
+        std::vector<bool> accepted(vertices.size(), true);
+        for (size_t i = 1; i < order.size(); i++) {
+            if (vertices[order[i]].info == vertices[order[i - 1]].info) {
+                accepted[order[i]] = false;
+                report("duplicate vertex", vertices[order[i]].info);
+            }
+        }
+
+        std::unordered_map<T, Vertex<T> *> &byInfo = graph.vertexMap;
+        byInfo.reserve(graph.vertexSet.size() + vertices.size());
+        graph.vertexSet.reserve(graph.vertexSet.size() + vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const VertexInput<T> &in = vertices[i];
+            if (!accepted[i]) continue;
+            if (byInfo.count(in.info)) {
+                report("vertex already in the graph", in.info);
+                continue;
+            }
+            Symbol code = graph.names.intern(in.code);
+            auto v = new Vertex<T>(in.info, graph.names.intern(in.location), code, in.hasParking);
+            v->setIndex(graph.vertexSet.size());
+            graph.vertexSet.push_back(v);
+            graph.codeToId[code] = in.info;
+            byInfo.emplace(in.info, v);
+        }
+
+        std::vector<SegmentInput<T>> resolved;
+        resolved.reserve(segments.size());
+        for (const SegmentByInfo<T> &s : segments) {
+            auto orig = byInfo.find(s.orig);
+            auto dest = byInfo.find(s.dest);
+            if (orig == byInfo.end() || dest == byInfo.end()) {
+                std::ostringstream message;
+                message << "segment with an unknown vertex " << s.orig << " -> " << s.dest;
+                errors.push_back(message.str());
+                continue;
+            }
+            resolved.push_back(SegmentInput<T>{orig->second, dest->second, s.drivingTime, s.walkingTime});
+        }
+        graph.addEdges(resolved);
+
+        std::vector<VertexInput<T>>().swap(vertices);
+        std::vector<SegmentByInfo<T>>().swap(segments);
+        return errors.empty();
+    }
+
+    /**
+     * @brief Returns a description of every item the last build() rejected.
+     */
+    const std::vector<std::string> &getErrors() const { return errors; }
+
+private:
+    std::vector<VertexInput<T>> vertices;
+    std::vector<SegmentByInfo<T>> segments;
+    std::vector<std::string> errors;
+
+    void report(const std::string &what, const T &info) {
+        std::ostringstream message;
+        message << what << " " << info;
+        errors.push_back(message.str());
+    }
+};
+
+#endif //GRAPH_BUILDER_H
@@ -0,0 +1,152 @@
+/**
+ * @file Path.h
+ * @brief A route stored as vertex and edge indices, split into legs.
+ *
+ * Routes are kept as the positions of their vertices in the graph's vertex set and the indices of their
+ * edges, so building, joining and splitting them never touches location names. Names are only looked up
+ * when a route is written out.
+ */
+
+#ifndef PATH_H
+#define PATH_H
+
+#include <ostream>
+#include <vector>
+
+#include "Graph.h"
+
+/**
+ * @class Path
+ * @brief A sequence of vertices joined by edges, made of one or more legs.
+ *
+ * A leg is a part of the route travelled in one way, for example driving to a parking place and then walking.
+ * Consecutive legs share the vertex where one ends and the next starts. Each leg has its own travel time.
+ *
+ * Vertex positions refer to Graph::getVertexSet() and stay valid until a vertex is removed from the graph.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class Path {
+public:
+    /**
+     * @brief Creates an empty path.
+     */
+    Path() = default;
+
+    /**
+     * @brief Creates a path of a single leg that starts, and for now ends, at a vertex.
+     */
+    explicit Path(const Vertex<T> *start) {
+        vertices.push_back(start->getIndex());
+        legStarts.push_back(0);
+        legTimes.push_back(0);
+    }
+
+    /**
+     * @brief Extends the last leg by an edge that leaves the last vertex of the path.
+     * @param time The time the edge adds to the leg.
+     */
+    void push(const Edge<T> *edge, int time) {
+        vertices.push_back(edge->getDest()->getIndex());
+        edges.push_back(edge->getIndex());
+        legTimes.back() += time;
+    }
+
+    /**
+     * @brief Appends another path as new legs.
+     *
+     * The other path must start at the last vertex of this one; that vertex is not repeated.
+     *
+     * @complexity O(L), where L is the length of the other path.
+     */
+    void append(const Path &other) {
+        if (other.empty()) return;
+        if (empty()) {
+            *this = other;
+            return;
+        }
+        size_t offset = vertices.size() - 1;
+        vertices.insert(vertices.end(), other.vertices.begin() + 1, other.vertices.end());
+        edges.insert(edges.end(), other.edges.begin(), other.edges.end());
+        for (size_t i = 0; i < other.legStarts.size(); i++) {
+            legStarts.push_back(offset + other.legStarts[i]);
+            legTimes.push_back(other.legTimes[i]);
+        }
+    }
+
+    /**
+     * @brief Sets the time of the last leg, for times that were not accumulated edge by edge.
+     */
+    void setLegTime(int time) { legTimes.back() = time; }
+
+    bool empty() const { return vertices.empty(); }
+
+    /**
+     * @brief Returns the number of vertices in the path.
+     */
+    size_t size() const { return vertices.size(); }
+
+    /// Positions of the vertices in Graph::getVertexSet(), in travel order.
+    const std::vector<int> &getVertices() const { return vertices; }
+    /// Indices (Edge::getIndex()) of the edges, in travel order.
+    const std::vector<int> &getEdges() const { return edges; }
+
+    int front() const { return vertices.front(); }
+    int back() const { return vertices.back(); }
+
+    size_t getNumLegs() const { return legStarts.size(); }
+
+    /**
+     * @brief Returns the position in getVertices() of the first vertex of a leg.
+     */
+    size_t getLegStart(size_t leg) const { return legStarts[leg]; }
+
+    /**
+     * @brief Returns the position in getVertices() of the last vertex of a leg.
+     */
+    size_t getLegEnd(size_t leg) const { return leg + 1 < legStarts.size() ? legStarts[leg + 1] : vertices.size() - 1; }
+
+    int getLegTime(size_t leg) const { return legTimes[leg]; }
+
+    /**
+     * @brief Returns the total time of all legs.
+     */
+    int getTime() const {
+        int total = 0;
+        for (int t : legTimes) total += t;
+        return total;
+    }
+
+    /**
+     * @brief Returns the vertex at a position of the path.
+     */
+    Vertex<T> *getVertex(const Graph<T> &g, size_t i) const { return g.getVertexSet()[vertices[i]]; }
+
+    /**
+     * @brief Writes the location names of the vertices in positions [first, end) separated by a string.
+     *
+     * @complexity O(end - first) plus the length of the names.
+     */
+    void render(std::ostream &os, const Graph<T> &g, const char *separator, size_t first, size_t end) const {
+        for (size_t i = first; i < end && i < vertices.size(); i++) {
+            if (i != first) os << separator;
+            os << getVertex(g, i)->getLocationSymbol();
+        }
+    }
+
+    /**
+     * @brief Writes the location names of all vertices separated by a string.
+     */
+    void render(std::ostream &os, const Graph<T> &g, const char *separator) const {
+        render(os, g, separator, 0, vertices.size());
+    }
+
+private:
+    std::vector<int> vertices;
+    std::vector<int> edges;
+    std::vector<size_t> legStarts;
+    std::vector<int> legTimes;
+};
+
+#endif //PATH_H
@@ -0,0 +1,107 @@
+/**
+ * @file SearchWorkspace.h
+ * @brief Per-query search state that is reset in constant time.
+ *
+ * A search that keeps its distances on the vertices has to reset every vertex before it starts, even when it
+ * only reaches a few of them. A workspace keeps the state in arrays indexed by vertex and edge, each entry
+ * stamped with the query that wrote it: starting a query just moves to a new stamp, and entries with an older
+ * stamp read as unreached. Reusing one workspace across queries therefore costs only the vertices each query
+ * actually touches.
+ */
+
+#ifndef SEARCH_WORKSPACE_H
+#define SEARCH_WORKSPACE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Graph.h"
+
+/**
+ * @class SearchWorkspace
+ * @brief Distances, parent edges and visited flags of one shortest-path search, plus the vertices and
+ * edges it must avoid.
+ *
+ * Entries are indexed by Vertex::getIndex() and Edge::getIndex(); the arrays grow when the graph does.
+ * A workspace must not be shared by two searches running at the same time.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class SearchWorkspace {
+public:
+    /**
+     * @brief Starts a new query: every vertex reads as unreached and unvisited, and nothing is avoided.
+     *
+     * @complexity O(1) amortized, plus the growth of the arrays when the graph got bigger.
+     */
+    void reset(const Graph<T> &g) {
+        if (vertices.size() < (size_t) g.getNumVertex()) vertices.resize(g.getNumVertex());
+        if (edgeStamps.size() < (size_t) g.getNumEdges()) edgeStamps.resize(g.getNumEdges(), 0);
+        if (++stamp == 0) { // Wrapped around: stamps written 2^32 queries ago would look current
+            for (Entry &e : vertices) e.stamp = 0;
+            std::fill(edgeStamps.begin(), edgeStamps.end(), 0);
+            stamp = 1;
+        }
+    }
+
+    /**
+     * @brief Marks vertices and edges the current query must not use.
+     *
+     * @complexity O(N + S), where N is the number of vertices and S the number of edges given.
+     */
+    void avoid(const std::vector<Vertex<T> *> &nodes, const std::vector<Edge<T> *> &segments) {
+        for (const Vertex<T> *v : nodes) touch(v).avoided = true;
+        for (const Edge<T> *e : segments) edgeStamps[e->getIndex()] = stamp;
+    }
+
+    bool isAvoided(const Vertex<T> *v) const { return current(v) && vertices[v->getIndex()].avoided; }
+    bool isAvoided(const Edge<T> *e) const { return edgeStamps[e->getIndex()] == stamp; }
+
+    /**
+     * @brief Returns the distance found to a vertex, or UNREACHABLE if the query has not reached it.
+     */
+    Distance getDist(const Vertex<T> *v) const { return current(v) ? vertices[v->getIndex()].dist : UNREACHABLE; }
+
+    /**
+     * @brief Returns the last edge of the path found to a vertex, or nullptr for the source and unreached vertices.
+     */
+    Edge<T> *getPath(const Vertex<T> *v) const { return current(v) ? vertices[v->getIndex()].path : nullptr; }
+
+    bool isVisited(const Vertex<T> *v) const { return current(v) && vertices[v->getIndex()].visited; }
+
+    void setVisited(const Vertex<T> *v) { touch(v).visited = true; }
+
+    void setDist(const Vertex<T> *v, Distance dist, Edge<T> *path) {
+        Entry &e = touch(v);
+        e.dist = dist;
+        e.path = path;
+    }
+
+private:
+    struct Entry {
+        uint32_t stamp = 0;
+        bool visited = false;
+        bool avoided = false;
+        Distance dist = UNREACHABLE;
+        Edge<T> *path = nullptr;
+    };
+
+    std::vector<Entry> vertices;
+    std::vector<uint32_t> edgeStamps; // equal to stamp for the edges the current query avoids
+    uint32_t stamp = 0;
+
+    bool current(const Vertex<T> *v) const { return vertices[v->getIndex()].stamp == stamp; }
+
+    /*
+     * Returns the entry of a vertex, clearing it first if an earlier query wrote it.
+     */
+    Entry &touch(const Vertex<T> *v) {
+        Entry &e = vertices[v->getIndex()];
+        if (e.stamp != stamp) e = Entry{stamp, false, false, UNREACHABLE, nullptr};
+        return e;
+    }
+};
+
+#endif //SEARCH_WORKSPACE_H
@@ -0,0 +1,194 @@
+/**
+ * @file StringPool.h
+ * @brief Interned strings stored in one contiguous pool.
+ *
+ * Location names and codes are repeated in every vertex, in Graph::codeToId and in every path that is
+ * returned. Interning stores each distinct string once and hands out a Symbol, a small handle that is
+ * copied, compared and hashed as an integer, so building and comparing paths no longer allocates.
+ */
+
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class StringPool;
+
+/**
+ * @class Symbol
+ * @brief Handle to a string interned in a StringPool.
+ *
+ * Two symbols of the same pool are equal exactly when their strings are equal. A default-constructed
+ * symbol stands for the empty string.
+ */
+class Symbol {
+public:
+    Symbol() = default;
+
+    /**
+     * @brief Returns the characters of the string, NUL-terminated.
+     *
+     * The pointer is only valid until the next string is interned into the pool.
+     */
+    const char *c_str() const;
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    std::string str() const { return std::string(c_str(), size()); }
+
+    /**
+     * @brief Returns the position of the string in its pool, unique per distinct string.
+     */
+    uint32_t getId() const { return id; }
+
+    bool operator==(const Symbol &other) const { return id == other.id && pool == other.pool; }
+    bool operator!=(const Symbol &other) const { return !(*this == other); }
+    bool operator==(const std::string &s) const {
+        return s.size() == size() && std::memcmp(s.data(), c_str(), s.size()) == 0;
+    }
+    bool operator!=(const std::string &s) const { return !(*this == s); }
+
+    friend std::ostream &operator<<(std::ostream &os, const Symbol &s) { return os.write(s.c_str(), s.size()); }
+
+private:
+    friend class StringPool;
+    Symbol(const StringPool *pool, uint32_t id) : pool(pool), id(id) {}
+
+    const StringPool *pool = nullptr;
+    uint32_t id = 0;
+};
+
+inline bool operator==(const std::string &s, const Symbol &sym) { return sym == s; }
+inline bool operator!=(const std::string &s, const Symbol &sym) { return sym != s; }
+
+namespace std {
+template <>
+struct hash<Symbol> {
+    size_t operator()(const Symbol &s) const { return std::hash<uint32_t>()(s.getId()); }
+};
+}
+
+/**
+ * @class StringPool
+ * @brief Stores each distinct string once, back to back in a single buffer.
+ *
+ * Every string is kept as a 4-byte length, its characters and a terminating NUL; a Symbol is the position
+ * of the characters in the buffer. Lookups go through an open-addressing table of those positions.
+ * A pool must outlive, and must not be moved while there are, symbols that refer to it.
+ */
+class StringPool {
+public:
+    StringPool() : slots(16, 0) {}
+
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    /**
+     * @brief Returns the symbol of a string, adding the string to the pool if it is not there yet.
+     *
+     * @complexity O(n) expected, where n is the length of the string.
+     */
+    Symbol intern(const char *s, size_t n) {
+        size_t h = hash(s, n);
+        size_t i = h & (slots.size() - 1);
+        while (slots[i] != 0) {
+            if (matches(slots[i], s, n)) return Symbol(this, slots[i]);
+            i = (i + 1) & (slots.size() - 1);
+        }
+
+        uint32_t length = static_cast<uint32_t>(n);
+        chars.insert(chars.end(), reinterpret_cast<const char *>(&length), reinterpret_cast<const char *>(&length) + 4);
+        uint32_t id = static_cast<uint32_t>(chars.size());
+        chars.insert(chars.end(), s, s + n);
+        chars.push_back('\0');
+
+        slots[i] = id;
+        if (++count * 2 > slots.size()) rehash();
+        return Symbol(this, id);
+    }
+
+    Symbol intern(const std::string &s) { return intern(s.data(), s.size()); }
+
+    /**
+     * @brief Returns the symbol of a string that is already in the pool.
+     * @return The symbol, or an empty symbol if the string was never interned (check with found()).
+     *
+     * @complexity O(n) expected, where n is the length of the string.
+     */
+    Symbol find(const char *s, size_t n) const {
+        size_t i = hash(s, n) & (slots.size() - 1);
+        while (slots[i] != 0) {
+            if (matches(slots[i], s, n)) return Symbol(this, slots[i]);
+            i = (i + 1) & (slots.size() - 1);
+        }
+        return Symbol();
+    }
+
+    Symbol find(const std::string &s) const { return find(s.data(), s.size()); }
+
+    /**
+     * @brief Tells whether a symbol returned by find() refers to a string of this pool.
+     */
+    bool found(const Symbol &s) const { return s.pool == this; }
+
+    /**
+     * @brief Returns the number of distinct strings.
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Returns the number of bytes used by the strings.
+     */
+    size_t bytes() const { return chars.size(); }
+
+private:
+    friend class Symbol;
+
+    std::vector<char> chars;     // [length][characters]['\0'] for every string
+    std::vector<uint32_t> slots; // positions of the characters in chars, 0 for an empty slot
+    size_t count = 0;
+
+    uint32_t length(uint32_t id) const {
+        uint32_t n;
+        std::memcpy(&n, chars.data() + id - 4, 4);
+        return n;
+    }
+
+    bool matches(uint32_t id, const char *s, size_t n) const {
+        return length(id) == n && std::memcmp(chars.data() + id, s, n) == 0;
+    }
+
+    void rehash() {
+        std::vector<uint32_t> old(slots.size() * 2, 0);
+        old.swap(slots);
+        for (uint32_t id : old) {
+            if (id == 0) continue;
+            size_t i = hash(chars.data() + id, length(id)) & (slots.size() - 1);
+            while (slots[i] != 0) i = (i + 1) & (slots.size() - 1);
+            slots[i] = id;
+        }
+    }
+
+    static size_t hash(const char *p, size_t n) { // FNV-1a
+        size_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < n; i++) {
+            h ^= static_cast<unsigned char>(p[i]);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+inline const char *Symbol::c_str() const {
+    return pool ? pool->chars.data() + id : "";
+}
+
+inline size_t Symbol::size() const {
+    return pool ? pool->length(id) : 0;
+}
+
+#endif //STRING_POOL_H
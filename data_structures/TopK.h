@@ -0,0 +1,132 @@
+/**
+ * @file TopK.h
+ * @brief Selection of the k best items without sorting all of them.
+ *
+ * Route alternatives are chosen among many candidates but only a few are shown. Keeping the k best in a
+ * bounded heap costs O(n log k) for n candidates instead of the O(n log n) of a full sort, and lets callers
+ * compare cheap summaries (times, ids) and build the full route only for the winners.
+ */
+
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/**
+ * @class BoundedHeap
+ * @brief Keeps the k best items offered to it.
+ *
+ * Items are ordered by a strict weak ordering where smaller is better. Among equal items the ones offered
+ * first are kept and come first, so the result does not depend on how the heap breaks ties.
+ *
+ * @tparam Item The type of the items; cheap to copy, such as a time and an index.
+ * @tparam Compare The ordering, true if the first item is better.
+ */
+template <class Item, class Compare = std::less<Item>>
+class BoundedHeap {
+public:
+    explicit BoundedHeap(size_t k, Compare better = Compare()) : k(k), better(better) { heap.reserve(k); }
+
+    /**
+     * @brief Offers an item, which is kept if fewer than k items are kept or it beats the worst of them.
+     * @return True if the item was kept.
+     *
+     * @complexity O(log k)
+     */
+    bool offer(const Item &item) {
+        if (k == 0) return false;
+        Entry entry{item, offered++};
+        auto ahead = [this](const Entry &a, const Entry &b) { return isAhead(a, b); };
+        if (heap.size() < k) {
+            heap.push_back(entry);
+            std::push_heap(heap.begin(), heap.end(), ahead);
+            return true;
+        }
+        if (!isAhead(entry, heap.front())) return false;
+        std::pop_heap(heap.begin(), heap.end(), ahead);
+        heap.back() = entry;
+        std::push_heap(heap.begin(), heap.end(), ahead);
+        return true;
+    }
+
+    size_t size() const { return heap.size(); }
+
+    bool full() const { return heap.size() == k; }
+
+    /**
+     * @brief Returns the worst item kept, the one the next item must beat once the heap is full.
+     */
+    const Item &worst() const { return heap.front().item; }
+
+    /**
+     * @brief Returns the items kept, best first, and empties the heap.
+     *
+     * @complexity O(k log k)
+     */
+    std::vector<Item> take() {
+        std::sort_heap(heap.begin(), heap.end(), [this](const Entry &a, const Entry &b) { return isAhead(a, b); });
+        std::vector<Item> items;
+        items.reserve(heap.size());
+        for (const Entry &e : heap) items.push_back(e.item);
+        heap.clear();
+        return items;
+    }
+
+private:
+    struct Entry {
+        Item item;
+        size_t order;
+    };
+
+    size_t k;
+    Compare better;
+    size_t offered = 0;
+    std::vector<Entry> heap; // heap ordered by isAhead(): the front is the worst item kept
+
+    /*
+     * Orders entries from best to worst, breaking ties by the order they were offered in.
+     */
+    bool isAhead(const Entry &a, const Entry &b) const {
+        if (better(a.item, b.item)) return true;
+        if (better(b.item, a.item)) return false;
+        return a.order < b.order;
+    }
+};
+
+/**
+ * @brief Selects up to k items from best to worst, skipping those a diversity rule rejects.
+ *
+ * Items are taken lazily from a heap, so only the items up to the k-th accepted one are ordered and passed to
+ * the rule. The rule can therefore build expensive data (such as a full route) for the few items it sees.
+ *
+ * @tparam Item The type of the items.
+ * @tparam Compare The ordering, true if the first item is better.
+ * @tparam Accept Called as accept(item, selected) with the items selected so far; false skips the item.
+ * @return The selected items, best first; equal items keep their order in the input.
+ *
+ * @complexity O(n + m log n) plus the cost of the rule, where m is the number of items passed to it.
+ */
+template <class Item, class Compare, class Accept>
+std::vector<Item> selectTopK(const std::vector<Item> &items, size_t k, Compare better, Accept accept) {
+    std::vector<size_t> heap(items.size());
+    for (size_t i = 0; i < heap.size(); i++) heap[i] = i;
+    auto worse = [&items, &better](size_t a, size_t b) {
+        if (better(items[a], items[b])) return false;
+        if (better(items[b], items[a])) return true;
+        return a > b;
+    };
+    std::make_heap(heap.begin(), heap.end(), worse);
+
+    std::vector<Item> selected;
+    while (selected.size() < k && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), worse);
+        const Item &item = items[heap.back()];
+        heap.pop_back();
+        if (accept(item, selected)) selected.push_back(item);
+    }
+    return selected;
+}
+
+#endif //TOP_K_H
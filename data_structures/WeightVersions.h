@@ -0,0 +1,246 @@
+/**
+ * @file WeightVersions.h
+ * @brief Versioned edge weights for applying traffic updates while queries are running.
+ *
+ * The travel times parsed from Distances.csv are copied into a WeightSnapshot. Updates never modify a
+ * published snapshot: VersionedWeights::apply builds the next version by sharing every block of weights
+ * that the batch does not touch and copying only the blocks that it does (copy-on-write). Queries hold a
+ * std::shared_ptr to the snapshot they started with, so they keep reading a consistent version until they
+ * finish, and the old blocks are released once the last reader drops them.
+ */
+
+#ifndef WEIGHT_VERSIONS_H
+#define WEIGHT_VERSIONS_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Graph.h"
+
+/**
+ * @brief The travel times of a single directed edge, packed into four bytes.
+ */
+struct EdgeWeights {
+    Weight drivingTime;
+    Weight walkingTime;
+};
+
+/**
+ * @brief A single change of a batch applied by VersionedWeights::apply.
+ *
+ * A negative time leaves that metric unchanged, and a time of IMPASSABLE or more closes it. Unless
+ * bothDirections is false the change is also applied to the reverse edge, which is what a two-way road needs.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+struct WeightUpdate {
+    Edge<T> *edge;
+    int drivingTime;
+    int walkingTime;
+    bool bothDirections = true;
+
+    /**
+     * @brief Sets new driving and walking times on a segment.
+     */
+    static WeightUpdate setTimes(Edge<T> *edge, int drivingTime, int walkingTime) {
+        return WeightUpdate{edge, drivingTime, walkingTime, true};
+    }
+
+    /**
+     * @brief Closes a segment to cars. Pedestrians can still use it.
+     */
+    static WeightUpdate close(Edge<T> *edge) {
+        return WeightUpdate{edge, IMPASSABLE, -1, true};
+    }
+
+    /**
+     * @brief Restores the times the segment had when it was loaded.
+     */
+    static WeightUpdate reopen(Edge<T> *edge) {
+        return WeightUpdate{edge, edge->getDrivingTime(), edge->getWalkingTime(), true};
+    }
+};
+
+template <class T>
+class VersionedWeights;
+
+/**
+ * @brief An immutable version of all edge weights of a graph.
+ *
+ * Weights are stored by edge index in fixed-size blocks. Snapshots of different versions share every
+ * block that did not change between them.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class WeightSnapshot {
+public:
+    static const int BLOCK_SIZE = 256; ///< Number of edges per copy-on-write block.
+
+    /**
+     * @brief Returns the version number, 0 for the weights the graph was loaded with.
+     */
+    unsigned long getVersion() const { return version; }
+
+    /**
+     * @brief Returns the weights of an edge in this version.
+     *
+     * Edges added to the graph after this snapshot was taken report the times stored on the edge itself.
+     *
+     * @complexity O(1)
+     */
+    EdgeWeights getWeights(const Edge<T> *edge) const {
+        int idx = edge->getIndex();
+        if (idx < 0 || idx >= numEdges) return EdgeWeights{edge->getDrivingTime(), edge->getWalkingTime()};
+        return (*blocks[idx / BLOCK_SIZE])[idx % BLOCK_SIZE];
+    }
+
+    Weight getDrivingTime(const Edge<T> *edge) const { return getWeights(edge).drivingTime; }
+    Weight getWalkingTime(const Edge<T> *edge) const { return getWeights(edge).walkingTime; }
+
+    /**
+     * @brief Returns the time of an edge for the given metric.
+     */
+    Weight getTime(const Edge<T> *edge, bool isDriving) const {
+        EdgeWeights w = getWeights(edge);
+        return isDriving ? w.drivingTime : w.walkingTime;
+    }
+
+private:
+    friend class VersionedWeights<T>;
+    typedef std::vector<EdgeWeights> Block;
+
+    unsigned long version = 0;
+    int numEdges = 0;
+    std::vector<std::shared_ptr<const Block>> blocks;
+};
+
+/**
+ * @brief Publishes successive versions of the edge weights of a graph.
+ *
+ * Readers call current() and run their query against the returned snapshot without taking any lock.
+ * Writers are serialized among themselves; a batch only copies the blocks it touches, so the cost of
+ * apply() is proportional to the size of the batch rather than to the size of the graph.
+ *
+ * The graph structure itself is not versioned: edges must not be removed from the graph while
+ * a snapshot that refers to them is in use.
+ *
+ * @tparam T The type of the vertex information.
+ */
+template <class T>
+class VersionedWeights {
+public:
+    /**
+     * @brief Builds version 0 from the driving and walking times stored on the edges of the graph.
+     *
+     * @complexity O(V + E)
+     */
+    explicit VersionedWeights(const Graph<T> &g) : g(g) {
+        auto first = std::make_shared<WeightSnapshot<T>>();
+        fill(*first, 0);
+        std::atomic_store(&head, std::shared_ptr<const WeightSnapshot<T>>(first));
+    }
+
+    /**
+     * @brief Returns the latest published version. Keep the pointer for the duration of a query.
+     *
+     * @complexity O(1)
+     */
+    std::shared_ptr<const WeightSnapshot<T>> current() const {
+        return std::atomic_load(&head);
+    }
+
+    /**
+     * @brief Applies a batch of weight changes and closures as one new version.
+     *
+     * @param batch The changes to apply. Later changes to the same edge win.
+     * @return The number of the version that was published.
+     *
+     * @complexity O(B + U * BLOCK_SIZE), where B is the number of blocks and U the number of updates.
+     */
+    unsigned long apply(const std::vector<WeightUpdate<T>> &batch) {
+        std::lock_guard<std::mutex> lock(writer);
+        std::shared_ptr<const WeightSnapshot<T>> prev = std::atomic_load(&head);
+
+        auto next = std::make_shared<WeightSnapshot<T>>(*prev);
+        next->version = prev->version + 1;
+        if (next->numEdges < g.getNumEdges()) fill(*next, prev->numEdges);
+
+        std::vector<std::shared_ptr<typename WeightSnapshot<T>::Block>> copied(next->blocks.size());
+        for (const WeightUpdate<T> &update : batch) {
+            if (update.edge == nullptr) continue;
+            write(*next, copied, update.edge, update.drivingTime, update.walkingTime);
+            if (update.bothDirections && update.edge->getReverse() != nullptr) {
+                write(*next, copied, update.edge->getReverse(), update.drivingTime, update.walkingTime);
+            }
+        }
+
+        std::atomic_store(&head, std::shared_ptr<const WeightSnapshot<T>>(next));
+        return next->version;
+    }
+
+    /**
+     * @brief Publishes a version that includes the edges added to the graph since the last version.
+     *
+     * Until then such edges are read with the times stored on the edge itself.
+     */
+    unsigned long sync() {
+        return apply({});
+    }
+
+private:
+    const Graph<T> &g;
+    std::shared_ptr<const WeightSnapshot<T>> head;
+    std::mutex writer;
+
+    /*
+     * Extends the snapshot with the current times of all edges with index >= from.
+     */
+    void fill(WeightSnapshot<T> &snap, int from) {
+        typedef typename WeightSnapshot<T>::Block Block;
+        const int size = WeightSnapshot<T>::BLOCK_SIZE;
+        int total = g.getNumEdges();
+        int numBlocks = (total + size - 1) / size;
+
+        std::vector<std::shared_ptr<Block>> fresh(numBlocks);
+        for (int b = from / size; b < numBlocks; b++) {
+            if (b < (int) snap.blocks.size()) fresh[b] = std::make_shared<Block>(*snap.blocks[b]);
+            else fresh[b] = std::make_shared<Block>();
+            fresh[b]->resize(std::min(size, total - b * size), EdgeWeights{IMPASSABLE, IMPASSABLE});
+        }
+
+        for (Vertex<T> *v : g.getVertexSet()) {
+            for (Edge<T> *e : v->getAdj()) {
+                int idx = e->getIndex();
+                if (idx >= from) (*fresh[idx / size])[idx % size] = EdgeWeights{e->getDrivingTime(), e->getWalkingTime()};
+            }
+        }
+
+        snap.blocks.resize(numBlocks);
+        for (int b = from / size; b < numBlocks; b++) snap.blocks[b] = fresh[b];
+        snap.numEdges = total;
+    }
+
+    /*
+     * Writes new times for one edge, copying its block the first time the batch touches it.
+     */
+    void write(WeightSnapshot<T> &snap, std::vector<std::shared_ptr<typename WeightSnapshot<T>::Block>> &copied,
+               const Edge<T> *edge, int drivingTime, int walkingTime) {
+        const int size = WeightSnapshot<T>::BLOCK_SIZE;
+        int idx = edge->getIndex();
+        if (idx < 0 || idx >= snap.numEdges) return;
+
+        int b = idx / size;
+        if (!copied[b]) {
+            copied[b] = std::make_shared<typename WeightSnapshot<T>::Block>(*snap.blocks[b]);
+            snap.blocks[b] = copied[b];
+        }
+        EdgeWeights &w = (*copied[b])[idx % size];
+        if (drivingTime >= 0) w.drivingTime = drivingTime < IMPASSABLE ? static_cast<Weight>(drivingTime) : IMPASSABLE;
+        if (walkingTime >= 0) w.walkingTime = walkingTime < IMPASSABLE ? static_cast<Weight>(walkingTime) : IMPASSABLE;
+    }
+};
+
+#endif //WEIGHT_VERSIONS_H
@@ -7,136 +7,264 @@
  * @brief Header file for Dijkstra's algorithm implementation.
  *
  * This file contains the implementation of Dijkstra's algorithm for finding the shortest paths in a graph.
+ * The search is a template over a weight policy, a function object that gives the cost of an edge as a
+ * Distance (UNREACHABLE for edges that cannot be used), so the metric is fixed at compile time and each
+ * metric gets its own specialized kernel. The policy also names the adjacency list the search scans, so
+ * driving searches use Vertex::getDrivingAdj() and never look at pedestrian-only segments.
  */
 
 #ifndef DIJKSTRA_H
 #define DIJKSTRA_H
 #include "./data_structures/Graph.h"
+#include "./data_structures/WeightVersions.h"
+#include "./data_structures/Path.h"
+#include "./data_structures/SearchWorkspace.h"
 #include <queue>
 #include <limits>
 #include <algorithm>
+#include <unordered_map>
 
 using namespace std;
 
 /**
- * @brief Relaxes an edge during the Dijkstra's algorithm.
+ * @brief Weight policy that uses the driving time of each edge.
+ */
+struct DrivingTime {
+    template <class T>
+    Distance operator()(const Edge<T> *edge) const { return toDistance(edge->getDrivingTime()); }
+
+    template <class T>
+    const std::vector<Edge<T> *> &adjacency(const Vertex<T> *v) const { return v->getDrivingAdj(); }
+
+    static Weight of(const EdgeWeights &weights) { return weights.drivingTime; }
+};
+
+/**
+ * @brief Weight policy that uses the walking time of each edge.
+ */
+struct WalkingTime {
+    template <class T>
+    Distance operator()(const Edge<T> *edge) const { return toDistance(edge->getWalkingTime()); }
+
+    template <class T>
+    const std::vector<Edge<T> *> &adjacency(const Vertex<T> *v) const { return v->getWalkingAdj(); }
+
+    static Weight of(const EdgeWeights &weights) { return weights.walkingTime; }
+};
+
+/**
+ * @brief Weight policy that adds a penalty to some edges on top of another policy.
  *
- * @tparam T The type of the vertex information.
- * @param edge Pointer to the edge to be relaxed.
- * @param isDriving Flag to indicate if the driving time should be used.
- * @return True if the edge was relaxed, false otherwise.
+ * Useful to steer a search away from a previous route without forbidding it.
  *
- * @complexity O(1)
+ * @tparam Base The policy that gives the cost of the edges without penalty.
  */
+template <class Base>
+struct PenalizedTime {
+    Base base;
+    const std::unordered_map<int, Distance> *penalties; ///< Extra cost by edge index (Edge::getIndex()).
 
-template <class T>
-bool relaxEdge(Edge<T> *edge, bool isDriving) { // d[u] + w(u,v) < d[v]
-
-    Vertex<T>* origin = edge->getOrig();
-    Vertex<T>* dest = edge->getDest();
-
-    // If we are only using driving time, we relax the edges using only that time
-    // Otherwise, we use only the walking time
-    if (isDriving) {
-        if (origin->getDist() + edge->getDrivingTime() < dest->getDist()) {
-            dest->setDist(origin->getDist() + edge->getDrivingTime());
-            dest->setPath(edge);
-            return true;
-        }
-    } else {
-        if (origin->getDist() + edge->getWalkingTime() < dest->getDist()) {
-            dest->setDist(origin->getDist() + edge->getWalkingTime());
-            dest->setPath(edge);
-            return true;
-        }
+    template <class T>
+    Distance operator()(const Edge<T> *edge) const {
+        auto it = penalties->find(edge->getIndex());
+        return it == penalties->end() ? base(edge) : saturatingAdd(base(edge), it->second);
     }
 
-    return false;
-}
+    template <class T>
+    const std::vector<Edge<T> *> &adjacency(const Vertex<T> *v) const { return base.adjacency(v); }
+};
 
 /**
- * @brief Runs Dijkstra's algorithm on the graph.
+ * @brief Weight policy that reads one metric from a version of the edge weights.
  *
- * @tparam T The type of the vertex information.
- * @param g Pointer to the graph object.
- * @param origin The starting vertex location.
- * @param nodesToAvoid Vector of nodes to avoid.
- * @param segmentsToAvoid Vector of segments to avoid.
- * @param isDriving Flag to indicate if the driving time should be used.
+ * ShortestPathTree is refreshed with it after each batch published through VersionedWeights.
+ * Scans every outgoing edge, since a version may reopen a segment that the graph itself marks impassable.
  *
- * @complexity O((V + E) \log V), where V is the number of vertices and E is the number of edges.
+ * @tparam T The type of the vertex information.
+ * @tparam Metric DrivingTime or WalkingTime.
  */
+template <class T, class Metric>
+struct SnapshotTime {
+    const WeightSnapshot<T> *weights;
 
-template <class T>
-void dijkstra(Graph<T> *g, const string &origin, std::vector<Vertex<T>*> nodesToAvoid, std::vector<Edge<T>*> segmentsToAvoid, bool isDriving) {
-    auto compare = [](Vertex<T>* left, Vertex<T>* right) { return left->getDist() > right->getDist(); };
-    std::priority_queue<Vertex<T>*, std::vector<Vertex<T>*>, decltype(compare)> q(compare);
-
-    for (Vertex<T>* v: g->getVertexSet()) {
-        v->setVisited(false);
-        v->setPath(nullptr);
-        v->setDist(500000);
+    Distance operator()(const Edge<T> *edge) const { return toDistance(Metric::of(weights->getWeights(edge))); }
+
+    const std::vector<Edge<T> *> &adjacency(const Vertex<T> *v) const { return v->getAdj(); }
+};
+
+/*
+ * Directions a search can follow edges in: Forward from origin to destination over WeightPolicy::adjacency(),
+ * Backward from destination to origin over Vertex::getIncoming().
+ */
+struct ForwardSearch {
+    template <class T, class WeightPolicy>
+    static const std::vector<Edge<T> *> &edges(const Vertex<T> *v, const WeightPolicy &weight) {
+        return weight.adjacency(v);
     }
 
-    Vertex<T>* start = g->findVertex(origin);
-    q.push(start);
-    start->setDist(0);
+    template <class T>
+    static const Vertex<T> *next(const Edge<T> *e) { return e->getDest(); }
+};
+
+struct BackwardSearch {
+    template <class T, class WeightPolicy>
+    static const std::vector<Edge<T> *> &edges(const Vertex<T> *v, const WeightPolicy &) { return v->getIncoming(); }
+
+    template <class T>
+    static const Vertex<T> *next(const Edge<T> *e) { return e->getOrig(); }
+};
+
+/**
+ * @brief Default callback of dijkstra(): never stops the search early.
+ */
+struct KeepSearching {
+    template <class T>
+    bool operator()(const Vertex<T> *, Distance) const { return true; }
+};
+
+/*
+ * The search loop shared by dijkstra() and reverseDijkstra(). Distances above limit are never recorded, so
+ * the search stops once everything within limit is settled; it also stops when onSettle returns false.
+ */
+template <class Direction, class T, class WeightPolicy, class Visitor>
+void runDijkstra(const Graph<T> *g, const Vertex<T> *start, const std::vector<Vertex<T>*> &nodesToAvoid,
+                 const std::vector<Edge<T>*> &segmentsToAvoid, const WeightPolicy &weight, SearchWorkspace<T> &search,
+                 Distance limit, const Visitor &onSettle) {
+    typedef std::pair<Distance, const Vertex<T>*> Entry;
+    auto compare = [](const Entry &left, const Entry &right) { return left.first > right.first; };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(compare)> q(compare);
+
+    search.reset(*g);
+    search.avoid(nodesToAvoid, segmentsToAvoid);
+    if (start == nullptr) return;
+
+    search.setDist(start, 0, nullptr);
+    q.push(std::make_pair(Distance(0), start));
 
     while (!q.empty()) {
-        Vertex<T>* v = q.top();
+        Entry top = q.top();
         q.pop();
-        v->setVisited(true);
-
-        for (Edge<T>* e: v->getAdj()) {
-            if (std::find(segmentsToAvoid.begin(), segmentsToAvoid.end(), e) != segmentsToAvoid.end()) continue;
-            Vertex<T>* u = e->getDest();
-            if (std::find(nodesToAvoid.begin(), nodesToAvoid.end(), u) == nodesToAvoid.end()) {
-                if (relaxEdge(e, isDriving)) {
-                    if (!u->isVisited()) {
-                        q.push(u);
-                    }
-                }
+        const Vertex<T>* v = top.second;
+        if (search.isVisited(v) || top.first > search.getDist(v)) continue;
+        search.setVisited(v);
+        if (!onSettle(v, top.first)) return;
+
+        for (Edge<T>* e: Direction::edges(v, weight)) {
+            const Vertex<T>* u = Direction::next(e);
+            if (search.isAvoided(e) || search.isAvoided(u) || search.isVisited(u)) continue;
+            Distance d = saturatingAdd(top.first, weight(e)); // d[v] + w(v,u) < d[u]
+            if (d <= limit && d < search.getDist(u)) {
+                search.setDist(u, d, e);
+                q.push(std::make_pair(d, u));
             }
         }
     }
 }
 
-
 /**
- * @brief Retrieves the path from the origin to the destination.
+ * @brief Runs Dijkstra's algorithm on the graph with a given weight policy, keeping its state in a workspace.
+ *
+ * Distances and the last edge of each shortest path are left in the workspace (see extractPath()); vertices
+ * that cannot be reached read as UNREACHABLE. Starting the search only resets the workspace's stamp, so the
+ * cost depends on the part of the graph the search reaches rather than on the size of the graph.
+ * The queue holds (distance, vertex) entries and entries made outdated by a later improvement are skipped,
+ * so the order of the queue never depends on distances that change after an entry was pushed.
  *
  * @tparam T The type of the vertex information.
+ * @tparam WeightPolicy The weight policy, called as weight(edge) for the cost of each edge and weight.adjacency(v)
+ * for the edges to scan from each vertex.
  * @param g Pointer to the graph object.
- * @param origin The starting vertex location.
- * @param dest The destination vertex location.
- * @return A pair containing the path as a vector of strings and the total distance.
+ * @param start The starting vertex.
+ * @param nodesToAvoid Vector of nodes to avoid.
+ * @param segmentsToAvoid Vector of segments to avoid.
+ * @param weight The weight policy.
+ * @param search The workspace the search writes to; its previous contents are discarded.
+ * @param limit Vertices farther than this read as unreached, and the search ends without reaching beyond it.
+ * @param onSettle Called as onSettle(v, distance) when the distance of a vertex becomes final, in order of
+ * distance; returning false ends the search, leaving the vertices not settled yet with tentative distances.
  *
- * @complexity O(V), where V is the number of vertices in the path.
+ * @complexity O((R + A) \log R + N + S), where R and A are the vertices and edges reached, and N and S the
+ * number of nodes and segments to avoid.
  */
-template <class T>
-std::pair<std::vector<std::string>, int> getPath(Graph<T> * g, const string &origin, const string &dest) {
-    std::pair<std::vector<string>, int> res;
-    std::vector<std::string> path;
-    int dist = 0;
+template <class T, class WeightPolicy, class Visitor = KeepSearching>
+void dijkstra(const Graph<T> *g, const Vertex<T> *start, const std::vector<Vertex<T>*> &nodesToAvoid,
+              const std::vector<Edge<T>*> &segmentsToAvoid, const WeightPolicy &weight, SearchWorkspace<T> &search,
+              Distance limit = UNREACHABLE, const Visitor &onSettle = Visitor()) {
+    runDijkstra<ForwardSearch>(g, start, nodesToAvoid, segmentsToAvoid, weight, search, limit, onSettle);
+}
+
+/**
+ * @brief Runs Dijkstra's algorithm backwards from a target, following the incoming edges of each vertex.
+ *
+ * The workspace holds the distance from every vertex to the target and, as its path, the first edge of the
+ * shortest path from it (see extractReversePath()). One reverse search answers "how far is the target" for
+ * every vertex at once, where forward searches would need one search per vertex.
+ *
+ * @param target The vertex every path leads to.
+ * @param limit Vertices farther than this from the target read as unreached.
+ *
+ * @complexity O((R + A) \log R + N + S), as dijkstra().
+ */
+template <class T, class WeightPolicy>
+void reverseDijkstra(const Graph<T> *g, const Vertex<T> *target, const std::vector<Vertex<T>*> &nodesToAvoid,
+                     const std::vector<Edge<T>*> &segmentsToAvoid, const WeightPolicy &weight,
+                     SearchWorkspace<T> &search, Distance limit = UNREACHABLE) {
+    runDijkstra<BackwardSearch>(g, target, nodesToAvoid, segmentsToAvoid, weight, search, limit, KeepSearching());
+}
 
-    Vertex<T>* dest_vertex = g->findVertex(dest);
-    dist = dest_vertex->getDist();
+/**
+ * @brief Retrieves the path found by a search from the origin to a vertex.
+ *
+ * @tparam T The type of the vertex information.
+ * @param search The workspace of the search.
+ * @param origin The vertex the search started from.
+ * @param target The vertex the path leads to.
+ * @return The path as a single leg, whose time is the distance of the target, or an empty path if the
+ * target was not reached.
+ *
+ * @complexity O(L), where L is the number of vertices in the path.
+ */
+template <class T>
+Path<T> extractPath(const SearchWorkspace<T> &search, const Vertex<T> *origin, const Vertex<T> *target) {
+    Distance dist = search.getDist(target);
+    if (dist == UNREACHABLE) return Path<T>();
 
-    while (dest_vertex != nullptr && dest_vertex->getLocation() != origin) {
-        path.push_back(dest_vertex->getLocation());
-        dest_vertex = dest_vertex->getPath() ? dest_vertex->getPath()->getOrig() : nullptr;
+    std::vector<const Edge<T> *> edges;
+    const Vertex<T> *v = target;
+    while (v != origin && search.getPath(v) != nullptr) {
+        edges.push_back(search.getPath(v));
+        v = search.getPath(v)->getOrig();
     }
 
-    if (dest_vertex != nullptr) {
-        path.push_back(dest_vertex->getLocation());
+    Path<T> path(v);
+    for (auto it = edges.rbegin(); it != edges.rend(); ++it) {
+        path.push(*it, 0);
     }
+    path.setLegTime((int) dist);
+    return path;
+}
 
-    std::reverse(path.begin(), path.end());
-
-    res.first = path;
-    res.second = dist;
+/**
+ * @brief Retrieves the path found by reverseDijkstra() from a vertex to the target it ran from.
+ *
+ * @return The path as a single leg, whose time is the distance of the origin, or an empty path if the
+ * origin was not reached.
+ *
+ * @complexity O(L), where L is the number of vertices in the path.
+ */
+template <class T>
+Path<T> extractReversePath(const SearchWorkspace<T> &search, const Vertex<T> *origin, const Vertex<T> *target) {
+    Distance dist = search.getDist(origin);
+    if (dist == UNREACHABLE) return Path<T>();
 
-    return res;
+    Path<T> path(origin);
+    const Vertex<T> *v = origin;
+    while (v != target && search.getPath(v) != nullptr) {
+        path.push(search.getPath(v), 0);
+        v = search.getPath(v)->getDest();
+    }
+    path.setLegTime((int) dist);
+    return path;
 }
 
 #endif //DIJKSTRA_H
@@ -1,6 +1,9 @@
 #include "./data_structures/Graph.h"
 #include "Parser.h"
+#include "GraphSnapshot.h"
+#include "DeltaApplier.h"
 #include "Menu.h"
+#include <fstream>
 #include <iostream>
 
 
@@ -28,11 +31,27 @@ int main() {
     // Menu<int> menu(&graph); //without batch mode
     Menu<int> menu(&graph, batch); // with batch mode
 
-    // Parse the Locations.csv file
-    Parser::parseLocations("../data/Locations.csv", graph);
+    // Load the binary snapshot written by 1stDA_Snapshot if it is up to date, otherwise parse the CSV files
+    GraphSnapshot snapshot;
+    bool opened = snapshot.open("../data/graph.snap");
+    if (opened && snapshot.isCurrent("../data/Locations.csv", "../data/Distances.csv")) {
+        cout << "Loading graph snapshot from ../data/graph.snap" << endl;
+        snapshot.toGraph(graph);
+    } else {
+        if (opened) cout << "../data/graph.snap is older than the CSV files, parsing them instead" << endl;
 
-    // Parse the Distances.csv file
-    Parser::parseDistances("../data/Distances.csv", graph);
+        // Parse the Locations.csv file
+        Parser::parseLocations("../data/Locations.csv", graph);
+
+        // Parse the Distances.csv file
+        Parser::parseDistances("../data/Distances.csv", graph);
+    }
+
+    // Apply the day's changes to the network, if there are any
+    if (std::ifstream("../data/Delta.csv")) {
+        cout << "Applying changes from ../data/Delta.csv" << endl;
+        DeltaApplier(graph).apply("../data/Delta.csv");
+    }
 
     // Display the parsed vertices
     cout << "Vertices:" << endl;
@@ -49,8 +68,10 @@ int main() {
     for (const auto& edge : graph.getEdges()) {
         cout << "Origin: " << edge->getOrig()->getCode()
              << ", Destination: " << edge->getDest()->getCode()
-             << ", Driving Time: " << edge->getDrivingTime()
-             << ", Walking Time: " << edge->getWalkingTime()
+             << ", Driving Time: ";
+        if (edge->getDrivingTime() == IMPASSABLE) cout << "X";
+        else cout << edge->getDrivingTime();
+        cout << ", Walking Time: " << edge->getWalkingTime()
              << endl;
     }
 
@@ -0,0 +1,74 @@
+/**
+ * @file ParserTest.cpp
+ * @brief Checks that parsing Distances.csv in parallel chunks gives the same graph as parsing it on one thread.
+ *
+ * The sample file is smaller than Parser::MIN_CHUNK_BYTES, so the check lowers the chunk size to force several
+ * chunks on several threads. Usage: ParserTest <data directory>. Exits with a non-zero status on a mismatch.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "Parser.h"
+
+namespace {
+
+/*
+ * Compares the vertices and the adjacency lists (destination, times and edge index, in order) of two graphs.
+ */
+bool sameGraph(const Graph<int> &a, const Graph<int> &b, std::string &error) {
+    if (a.getNumVertex() != b.getNumVertex() || a.getNumEdges() != b.getNumEdges()) {
+        error = "different numbers of vertices or edges";
+        return false;
+    }
+    for (int v = 0; v < a.getNumVertex(); v++) {
+        const std::vector<Edge<int> *> &adjA = a.getVertexSet()[v]->getAdj();
+        const std::vector<Edge<int> *> &adjB = b.getVertexSet()[v]->getAdj();
+        if (adjA.size() != adjB.size()) {
+            error = "vertex " + std::to_string(a.getVertexSet()[v]->getInfo()) + " has a different degree";
+            return false;
+        }
+        for (size_t i = 0; i < adjA.size(); i++) {
+            const Edge<int> *x = adjA[i], *y = adjB[i];
+            if (x->getDest()->getInfo() != y->getDest()->getInfo() || x->getDrivingTime() != y->getDrivingTime()
+                || x->getWalkingTime() != y->getWalkingTime() || x->getIndex() != y->getIndex()) {
+                error = "vertex " + std::to_string(a.getVertexSet()[v]->getInfo()) + " has a different edge "
+                        + std::to_string(i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <data directory>" << std::endl;
+        return 2;
+    }
+    const std::string locations = std::string(argv[1]) + "/Locations.csv";
+    const std::string distances = std::string(argv[1]) + "/Distances.csv";
+
+    Graph<int> serial;
+    Parser::parseLocations(locations, serial);
+    Parser::parseDistances(distances, serial, 1);
+    if (serial.getNumEdges() == 0) {
+        std::cerr << "Could not parse " << distances << std::endl;
+        return 1;
+    }
+
+    for (unsigned threads : {2u, 4u, 7u}) {
+        Graph<int> parallel;
+        Parser::parseLocations(locations, parallel);
+        Parser::parseDistances(distances, parallel, threads, 1024);
+        std::string error;
+        if (!sameGraph(serial, parallel, error)) {
+            std::cerr << "Parsing on " << threads << " threads differs from one thread: " << error << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Parser: parallel chunks give the same graph as one thread" << std::endl;
+    return 0;
+}
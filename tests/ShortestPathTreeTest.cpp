@@ -0,0 +1,161 @@
+/**
+ * @file ShortestPathTreeTest.cpp
+ * @brief Checks that repairing a ShortestPathTree gives the same tree as building it again.
+ *
+ * Random graphs get batches of closed, reopened and re-timed segments through VersionedWeights (repaired with
+ * refresh()), and inserted, removed and re-timed edges in the graph itself (repaired with update()). After
+ * every change the repaired tree must have the distances of a tree built from scratch, and parent edges that
+ * realize them. Exits with a non-zero status on the first mismatch.
+ */
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dijkstra.h"
+#include "ShortestPathTree.h"
+#include "./data_structures/GraphBuilder.h"
+
+namespace {
+
+/*
+ * Compares a repaired tree with one built from scratch, describing the first difference in error.
+ */
+template <class WeightPolicy>
+bool sameAsRebuilt(const Graph<int> &g, const ShortestPathTree<int> &tree, const WeightPolicy &weight,
+                   std::string &error) {
+    ShortestPathTree<int> fresh(&g, tree.getSource());
+    fresh.build(weight);
+    for (Vertex<int> *v : g.getVertexSet()) {
+        if (tree.getDist(v) != fresh.getDist(v)) {
+            error = "vertex " + std::to_string(v->getInfo()) + ": distance " + std::to_string(tree.getDist(v))
+                    + ", rebuilt " + std::to_string(fresh.getDist(v));
+            return false;
+        }
+        Edge<int> *e = tree.getParent(v);
+        if (e == nullptr) continue;
+        if (e->getDest() != v || saturatingAdd(tree.getDist(e->getOrig()), weight(e)) != tree.getDist(v)) {
+            error = "vertex " + std::to_string(v->getInfo()) + ": parent edge does not realize its distance";
+            return false;
+        }
+    }
+    return true;
+}
+
+Edge<int> *randomEdge(const Graph<int> &g, std::mt19937 &rng) {
+    for (int tries = 0; tries < 100; tries++) {
+        const std::vector<Edge<int> *> &adj = g.getVertexSet()[rng() % g.getNumVertex()]->getAdj();
+        if (!adj.empty()) return adj[rng() % adj.size()];
+    }
+    return nullptr;
+}
+
+Graph<int> *randomGraph(std::mt19937 &rng) {
+    auto *g = new Graph<int>();
+    GraphBuilder<int> builder;
+    int n = 5 + rng() % 30;
+    for (int i = 0; i < n; i++) builder.addVertex(i, "L" + std::to_string(i), "C" + std::to_string(i), false);
+    for (int j = 0, m = n + rng() % (2 * n); j < m; j++) {
+        int a = rng() % n, b = rng() % n;
+        if (a != b) builder.addSegment(a, b, 1 + rng() % 9, 1 + rng() % 9);
+    }
+    builder.build(*g);
+    for (int j = 0; j < n / 4; j++) {
+        g->addDirectedEdge(g->getVertexSet()[rng() % n], g->getVertexSet()[rng() % n], 1 + rng() % 9, 1 + rng() % 9);
+    }
+    return g;
+}
+
+/*
+ * Closes, reopens and re-times segments in batches through VersionedWeights, repairing with refresh().
+ */
+bool checkRefresh(std::mt19937 &rng, std::string &error) {
+    std::unique_ptr<Graph<int>> g(randomGraph(rng));
+    VersionedWeights<int> versions(*g);
+    std::shared_ptr<const WeightSnapshot<int>> snapshot = versions.current();
+    ShortestPathTree<int> tree(g.get(), g->getVertexSet()[0]);
+    tree.build(SnapshotTime<int, DrivingTime>{snapshot.get()});
+
+    std::vector<Edge<int> *> closed;
+    for (int round = 0; round < 20; round++) {
+        std::vector<WeightUpdate<int>> batch;
+        for (int k = 1 + rng() % 4; k > 0; k--) {
+            int action = rng() % 3;
+            if (action == 0 && !closed.empty()) {
+                batch.push_back(WeightUpdate<int>::reopen(closed.back()));
+                closed.pop_back();
+            } else if (Edge<int> *e = randomEdge(*g, rng)) {
+                if (action == 1) {
+                    batch.push_back(WeightUpdate<int>::close(e));
+                    closed.push_back(e);
+                } else {
+                    batch.push_back(WeightUpdate<int>::setTimes(e, 1 + rng() % 9, 1 + rng() % 9));
+                }
+            }
+        }
+        versions.apply(batch);
+        snapshot = versions.current();
+        SnapshotTime<int, DrivingTime> weight{snapshot.get()};
+        tree.refresh(weight, batch);
+        if (!sameAsRebuilt(*g, tree, weight, error)) return false;
+    }
+    return true;
+}
+
+/*
+ * Inserts, removes and re-times edges of the graph itself, repairing with update().
+ */
+bool checkUpdate(std::mt19937 &rng, std::string &error) {
+    std::unique_ptr<Graph<int>> g(randomGraph(rng));
+    const std::vector<Vertex<int> *> &vertices = g->getVertexSet();
+    ShortestPathTree<int> tree(g.get(), vertices[0]);
+    tree.build(DrivingTime());
+
+    for (int round = 0; round < 20; round++) {
+        int action = rng() % 3;
+        Edge<int> *e = randomEdge(*g, rng);
+        if (action == 0 || e == nullptr) {
+            Edge<int> *added = g->addDirectedEdge(vertices[rng() % vertices.size()], vertices[rng() % vertices.size()],
+                                                  1 + rng() % 9, 1 + rng() % 9);
+            tree.update(DrivingTime(), {added});
+        } else if (action == 1) {
+            // Graph::removeEdge removes every edge between the pair
+            Vertex<int> *orig = e->getOrig(), *dest = e->getDest();
+            std::vector<Edge<int> *> removed;
+            for (Edge<int> *parallel : orig->getAdj()) {
+                if (parallel->getDest() == dest) removed.push_back(parallel);
+            }
+            tree.update(DrivingTime(), {}, removed);
+            g->removeEdge(orig->getInfo(), dest->getInfo());
+        } else {
+            // Both directions of a segment share their times
+            e->setDrivingTime(1 + rng() % 9);
+            std::vector<Edge<int> *> changed = {e};
+            if (e->isUndirected() && e->getReverse() != nullptr) changed.push_back(e->getReverse());
+            tree.update(DrivingTime(), changed);
+        }
+        if (!sameAsRebuilt(*g, tree, DrivingTime(), error)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(2025);
+    std::string error;
+    for (int graph = 0; graph < 200; graph++) {
+        if (!checkRefresh(rng, error)) {
+            std::cerr << "refresh() differs from build() on graph " << graph << ": " << error << std::endl;
+            return 1;
+        }
+        if (!checkUpdate(rng, error)) {
+            std::cerr << "update() differs from build() on graph " << graph << ": " << error << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "ShortestPathTree: repaired trees match rebuilt ones" << std::endl;
+    return 0;
+}